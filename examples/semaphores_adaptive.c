@@ -0,0 +1,204 @@
+#include <sys/types.h>   // For pid_t
+#include <sys/ipc.h>     // For IPC_PRIVATE, etc.
+#include <sys/shm.h>     // For shared memory functions
+#include <sys/syscall.h> // For SYS_futex
+#include <sys/wait.h>    // For wait
+#include <linux/futex.h> // For FUTEX_WAIT, FUTEX_WAKE
+#include <stdatomic.h>   // For atomic_* operations
+#include <stdint.h>      // For uint64_t
+#include <stdio.h>       // For printf, perror
+#include <stdlib.h>      // For exit, atoi
+#include <time.h>        // For clock_gettime
+#include <unistd.h>      // For fork, sysconf
+#include <x86intrin.h>   // For __rdtsc, _mm_pause (x86 only)
+
+// A semaphore whose down() spins briefly before it sleeps.
+//
+// down() in semaphores.c goes to sleep in the kernel as soon as the count is 0, and up()
+// has to wake it again: two context switches, typically several microseconds, even if the
+// holder was going to call up() a few hundred nanoseconds later. This semaphore keeps its
+// count in shared memory, so a waiter can watch it without system calls. It first spins
+// (with pause, which lets the sibling hyperthread run and saves power) and only sleeps on
+// a futex if the count stays 0.
+//
+// How long to spin is tuned from what the semaphore observes: up() measures how long the
+// semaphore was held and keeps a moving average. If twice that is below MAX_SPIN, roughly
+// what sleeping and being woken costs, down() spins that long; otherwise waiting is expected
+// to take longer than a sleep would, and it blocks without spinning at all. Short critical
+// sections get a short spin that usually succeeds; long ones don't burn CPU. On a single
+// CPU the holder can't run while we spin, so the spin is skipped entirely.
+
+#define MAX_SPIN 20000 // Cycles: about the cost of a futex sleep and wakeup (~6 us)
+
+enum wait_mode { BLOCK, FIXED_SPIN, ADAPTIVE };
+
+struct adaptive_sem {
+    _Alignas(64) _Atomic int value;
+    _Atomic int waiters;
+    _Alignas(64) _Atomic uint64_t hold_avg;    // Cycles, moving average over ~8 holds
+    _Atomic uint64_t acquired_at;              // Timestamp of the last successful down()
+    _Atomic long spin_acquires, blocks;        // Statistics
+};
+
+int spin_allowed = 1; // Cleared on single-CPU machines
+
+long futex(_Atomic int *addr, int op, int val) {
+    return syscall(SYS_futex, addr, op, val, NULL, NULL, 0);
+}
+
+void sem_setup(struct adaptive_sem *s, int value) {
+    atomic_store(&s->value, value);
+    atomic_store(&s->waiters, 0);
+    atomic_store(&s->hold_avg, 0);
+    atomic_store(&s->spin_acquires, 0);
+    atomic_store(&s->blocks, 0);
+}
+
+int try_down(struct adaptive_sem *s) {
+    int v = atomic_load_explicit(&s->value, memory_order_relaxed);
+    while (v > 0)
+        if (atomic_compare_exchange_weak(&s->value, &v, v - 1))
+            return 1;
+    return 0;
+}
+
+// Function to perform a semaphore "down" (decrement) operation
+void down(struct adaptive_sem *s, enum wait_mode mode) {
+    if (!try_down(s)) {
+        uint64_t budget = 0;
+        if (spin_allowed && mode == FIXED_SPIN) {
+            budget = MAX_SPIN;
+        } else if (spin_allowed && mode == ADAPTIVE) {
+            budget = 2 * atomic_load_explicit(&s->hold_avg, memory_order_relaxed);
+            if (budget > MAX_SPIN)
+                budget = 0; // Expected wait costs more than sleeping: block at once
+        }
+        uint64_t start = __rdtsc();
+        int acquired = 0;
+        while (__rdtsc() - start < budget) {
+            if (atomic_load_explicit(&s->value, memory_order_relaxed) > 0 && try_down(s)) {
+                acquired = 1;
+                break;
+            }
+            _mm_pause();
+        }
+        if (acquired) {
+            atomic_fetch_add_explicit(&s->spin_acquires, 1, memory_order_relaxed);
+        } else {
+            atomic_fetch_add_explicit(&s->blocks, 1, memory_order_relaxed);
+            atomic_fetch_add(&s->waiters, 1);
+            while (!try_down(s))
+                futex(&s->value, FUTEX_WAIT, 0); // Returns at once if the count is no longer 0
+            atomic_fetch_sub(&s->waiters, 1);
+        }
+    }
+    atomic_store_explicit(&s->acquired_at, __rdtsc(), memory_order_relaxed);
+}
+
+// Function to perform a semaphore "up" (increment) operation
+void up(struct adaptive_sem *s) {
+    uint64_t held = __rdtsc() - atomic_load_explicit(&s->acquired_at, memory_order_relaxed);
+    uint64_t avg = atomic_load_explicit(&s->hold_avg, memory_order_relaxed);
+    held = held < 8 * (uint64_t)MAX_SPIN ? held : 8 * (uint64_t)MAX_SPIN; // Ignore outliers (preemption)
+    atomic_store_explicit(&s->hold_avg, avg - avg / 8 + held / 8, memory_order_relaxed);
+    atomic_fetch_add(&s->value, 1);
+    if (atomic_load(&s->waiters) > 0)
+        futex(&s->value, FUTEX_WAKE, 1);
+}
+
+double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Busy work standing in for a critical section (or for the work between them)
+uint64_t work(uint64_t x, int rounds) {
+    for (int i = 0; i < rounds; i++)
+        x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+    return x;
+}
+
+struct shared {
+    struct adaptive_sem lock;
+    _Alignas(64) long counter;
+};
+
+// Usage: semaphores_adaptive [processes]
+int main(int argc, char *argv[]) {
+    int procs = argc > 1 ? atoi(argv[1]) : 4;
+    if (procs < 1) {
+        fprintf(stderr, "need at least one process\n");
+        exit(1);
+    }
+    spin_allowed = sysconf(_SC_NPROCESSORS_ONLN) > 1;
+    int shmid = shmget(IPC_PRIVATE, sizeof(struct shared), IPC_CREAT | 0666);
+    if (shmid == -1) {
+        perror("shmget failed");
+        exit(1);
+    }
+    struct shared *sh = shmat(shmid, NULL, 0); // Attached before fork: children inherit it
+    if (sh == (void *)-1) {
+        perror("shmat failed");
+        exit(1);
+    }
+    if (!spin_allowed)
+        printf("Single CPU: spinning can't help, every mode blocks at once\n");
+
+    // Short critical sections (100 steps) and long ones (20000), with work in between
+    int sections[] = {100, 20000};
+    const char *names[] = {"block", "fixed spin", "adaptive"};
+    for (int c = 0; c < 2; c++) {
+        long n = c == 0 ? 200000 : 2000;
+        printf("Critical section of %d steps, %d processes:\n", sections[c], procs);
+        for (int mode = BLOCK; mode <= ADAPTIVE; mode++) {
+            sem_setup(&sh->lock, 1);
+            sh->counter = 0;
+            double start = now_sec();
+            for (int p = 0; p < procs; p++) {
+                fflush(stdout);
+                pid_t pid = fork();
+                if (pid == -1) {
+                    perror("fork failed");
+                    exit(1);
+                }
+                if (pid == 0) {
+                    uint64_t x = p;
+                    for (long i = 0; i < n; i++) {
+                        down(&sh->lock, mode);
+                        x = work(x, sections[c]);
+                        sh->counter++;
+                        up(&sh->lock);
+                        x = work(x, 3 * sections[c]);
+                    }
+                    exit(x == 42); // Keeps the work from being optimized away
+                }
+            }
+            for (int p = 0; p < procs; p++) {
+                if (wait(NULL) == -1) {
+                    perror("wait failed");
+                    exit(1);
+                }
+            }
+            double elapsed = now_sec() - start;
+            if (sh->counter != procs * n) {
+                fprintf(stderr, "lost updates: %ld of %ld\n", sh->counter, procs * n);
+                exit(1);
+            }
+            printf("  %-10s %8.0f ns per section, %6.1f%% of waits won by spinning, %ld slept (avg hold %lu cycles)\n",
+                   names[mode], elapsed * 1e9 / (procs * n),
+                   100.0 * sh->lock.spin_acquires / (sh->lock.spin_acquires + sh->lock.blocks + !(sh->lock.spin_acquires + sh->lock.blocks)),
+                   sh->lock.blocks, (unsigned long)sh->lock.hold_avg);
+        }
+    }
+
+    if (shmdt(sh) == -1) {
+        perror("shmdt failed");
+        exit(1);
+    }
+    if (shmctl(shmid, IPC_RMID, NULL) == -1) {
+        perror("Cleaning up (shmctl) failed");
+        exit(1);
+    }
+    return 0;
+}
@@ -0,0 +1,223 @@
+#include <sys/types.h>   // For pid_t
+#include <sys/ipc.h>     // For IPC_PRIVATE, etc.
+#include <sys/shm.h>     // For shared memory functions
+#include <sys/sem.h>     // For semaphore functions
+#include <sys/syscall.h> // For SYS_futex
+#include <sys/wait.h>    // For wait
+#include <linux/futex.h> // For FUTEX_WAIT, FUTEX_WAKE
+#include <limits.h>      // For INT_MAX
+#include <stdatomic.h>   // For atomic_* operations
+#include <stdint.h>      // For uint32_t
+#include <stdio.h>       // For printf, perror
+#include <stdlib.h>      // For exit, atoi
+#include <time.h>        // For clock_gettime
+#include <unistd.h>      // For fork, sysconf
+
+// Barriers: N processes wait until all of them have arrived, then all continue, phase after
+// phase. semaphores.c synchronizes exactly two processes; three reusable N-process barriers:
+//
+// - central: a counter and a "sense" flag in shared memory. Each process flips its own
+//   sense every phase and decrements the counter; the last to arrive resets the counter and
+//   sets the shared sense to match, which releases everyone. Waiters spin briefly, then
+//   sleep on the flag with futex(), and the last arrival wakes them all with one call.
+// - semop: three SysV semaphores used in rotation. Arriving in phase p takes 1 from
+//   semaphore p % 3 and, in the same atomic semop, gives 1 to semaphore (p + 1) % 3; then
+//   the process waits for p % 3 to reach zero (sem_op = 0). The refill targets the
+//   semaphore last used two phases ago, which everyone has certainly stopped waiting on:
+//   with only two, a fast process could refill one before a slow one had even started
+//   its wait for zero, and the slow one would wait forever.
+// - dissemination: log2(N) rounds; in round r, process i signals process (i + 2^r) mod N
+//   and waits for (i - 2^r) mod N. No process waits on a word more than one other process
+//   writes, so nothing is contended, where the central counter serializes all N arrivals
+//   on one cache line. With enough CPUs to run every process at once, this is the one that
+//   keeps latency low at 64 processes and up; on few CPUs, its log2(N) handoffs per
+//   process cost more sleeps than a single broadcast wakeup.
+//
+// Usage: semaphores_barrier [max processes]
+
+#define MAX_PROCS 256
+#define MAX_ROUNDS 8 // log2(MAX_PROCS)
+
+struct flag {
+    _Alignas(64) _Atomic uint32_t phase; // Last phase in which this process was signalled
+    _Atomic uint32_t sleepers;
+};
+
+struct shared {
+    _Alignas(64) _Atomic int count;      // Central barrier
+    _Atomic uint32_t sense;
+    _Atomic uint32_t sleepers;
+    struct flag flags[MAX_ROUNDS][MAX_PROCS]; // Dissemination barrier
+    _Alignas(64) _Atomic long arrivals;       // For checking
+};
+
+struct shared *sh;
+int semid, nprocs, spin_limit = 1000;
+
+long futex(_Atomic uint32_t *addr, int op, uint32_t val) {
+    return syscall(SYS_futex, addr, op, val, NULL, NULL, 0);
+}
+
+// Function to wait until *word != old: spin a little, then sleep (counted in *sleepers)
+void wait_change(_Atomic uint32_t *word, uint32_t old, _Atomic uint32_t *sleepers) {
+    for (int i = 0; i < spin_limit; i++)
+        if (atomic_load(word) != old)
+            return;
+    atomic_fetch_add(sleepers, 1);
+    while (atomic_load(word) == old)
+        futex(word, FUTEX_WAIT, old);
+    atomic_fetch_sub(sleepers, 1);
+}
+
+// Central sense-reversing barrier; *local_sense is this process's sense, flipped every phase
+void central_wait(uint32_t *local_sense) {
+    *local_sense = !*local_sense;
+    if (atomic_fetch_sub(&sh->count, 1) == 1) { // Last to arrive
+        atomic_store(&sh->count, nprocs);
+        atomic_store(&sh->sense, *local_sense);
+        if (atomic_load(&sh->sleepers) > 0)
+            futex(&sh->sense, FUTEX_WAKE, INT_MAX);
+    } else {
+        wait_change(&sh->sense, !*local_sense, &sh->sleepers);
+    }
+}
+
+union semun { int val; }; // Union for semctl arguments
+
+// semop barrier; *phase counts this process's phases
+void semop_wait(uint32_t *phase) {
+    int now = *phase % 3;
+    struct sembuf arrive[2] = {{now, -1, 0}, {(now + 1) % 3, 1, 0}};
+    struct sembuf all_here = {now, 0, 0}; // Wait for zero
+    if (semop(semid, arrive, 2) == -1 || semop(semid, &all_here, 1) == -1) {
+        perror("semop failed");
+        exit(1);
+    }
+    (*phase)++;
+}
+
+// Dissemination barrier for process `me`; *phase counts this process's phases
+void dissemination_wait(int me, uint32_t *phase) {
+    uint32_t p = ++*phase;
+    for (int r = 0, dist = 1; dist < nprocs; r++, dist *= 2) {
+        struct flag *to = &sh->flags[r][(me + dist) % nprocs];
+        atomic_store(&to->phase, p); // Phases only grow, so a partner running ahead is harmless
+        if (atomic_load(&to->sleepers) > 0)
+            futex(&to->phase, FUTEX_WAKE, 1);
+        struct flag *mine = &sh->flags[r][me];
+        uint32_t seen;
+        while ((seen = atomic_load(&mine->phase)) < p)
+            wait_change(&mine->phase, seen, &mine->sleepers);
+    }
+}
+
+double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Function to time `phases` barriers with `procs` processes; microseconds per barrier
+double run(int kind, int procs, int phases) {
+    nprocs = procs;
+    atomic_store(&sh->count, procs);
+    atomic_store(&sh->sense, 0);
+    atomic_store(&sh->arrivals, 0);
+    for (int r = 0; r < MAX_ROUNDS; r++)
+        for (int i = 0; i < MAX_PROCS; i++)
+            atomic_store(&sh->flags[r][i].phase, 0);
+    for (int i = 0; i < 3; i++) {
+        union semun arg = {i == 0 ? procs : 0};
+        if (semctl(semid, i, SETVAL, arg) == -1) {
+            perror("semctl failed");
+            exit(1);
+        }
+    }
+
+    double start = now_sec();
+    for (int me = 0; me < procs; me++) {
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid == -1) {
+            perror("fork failed");
+            exit(1);
+        }
+        if (pid != 0)
+            continue;
+        uint32_t state = 0;
+        for (long p = 1; p <= phases; p++) {
+            atomic_fetch_add(&sh->arrivals, 1);
+            if (kind == 0)
+                central_wait(&state);
+            else if (kind == 1)
+                semop_wait(&state);
+            else
+                dissemination_wait(me, &state);
+            if (atomic_load(&sh->arrivals) < p * procs) { // Someone hasn't arrived yet
+                fprintf(stderr, "process %d left phase %ld early\n", me, p);
+                exit(1);
+            }
+        }
+        exit(0);
+    }
+    int failed = 0;
+    for (int me = 0; me < procs; me++) {
+        int status;
+        if (wait(&status) == -1) {
+            perror("wait failed");
+            exit(1);
+        }
+        failed |= !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+    }
+    if (failed)
+        exit(1);
+    return (now_sec() - start) * 1e6 / phases;
+}
+
+int main(int argc, char *argv[]) {
+    int max_procs = argc > 1 ? atoi(argv[1]) : 64;
+    if (max_procs < 2 || max_procs > MAX_PROCS) {
+        fprintf(stderr, "processes must be between 2 and %d\n", MAX_PROCS);
+        exit(1);
+    }
+    if (sysconf(_SC_NPROCESSORS_ONLN) == 1)
+        spin_limit = 0; // Nobody else can run while we spin
+    int shmid = shmget(IPC_PRIVATE, sizeof(struct shared), IPC_CREAT | 0666);
+    if (shmid == -1) {
+        perror("shmget failed");
+        exit(1);
+    }
+    sh = shmat(shmid, NULL, 0); // Attached before fork: children inherit it
+    if (sh == (void *)-1) {
+        perror("shmat failed");
+        exit(1);
+    }
+    semid = semget(IPC_PRIVATE, 3, IPC_CREAT | 0666);
+    if (semid == -1) {
+        perror("semget failed");
+        exit(1);
+    }
+
+    printf("%-11s %12s %12s %14s\n", "processes", "central", "semop", "dissemination");
+    for (int procs = 2; procs <= max_procs; procs *= 2) {
+        int phases = 20000 / procs;
+        printf("%-11d", procs);
+        for (int kind = 0; kind < 3; kind++)
+            printf(" %12.1f", run(kind, procs, phases));
+        printf("   (us per barrier)\n");
+    }
+
+    if (shmdt(sh) == -1) {
+        perror("shmdt failed");
+        exit(1);
+    }
+    if (shmctl(shmid, IPC_RMID, NULL) == -1) {
+        perror("Cleaning up (shmctl) failed");
+        exit(1);
+    }
+    if (semctl(semid, 0, IPC_RMID) == -1) {
+        perror("Cleaning up (semctl) failed");
+        exit(1);
+    }
+    return 0;
+}
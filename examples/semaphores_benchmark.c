@@ -0,0 +1,349 @@
+#include <sys/types.h>   // For pid_t
+#include <sys/ipc.h>     // For IPC_PRIVATE, etc.
+#include <sys/shm.h>     // For shared memory functions
+#include <sys/sem.h>     // For semaphore functions
+#include <sys/eventfd.h> // For eventfd
+#include <sys/syscall.h> // For SYS_futex
+#include <sys/wait.h>    // For wait
+#include <linux/futex.h> // For FUTEX_WAIT, FUTEX_WAKE
+#include <pthread.h>     // For process-shared mutexes and condition variables
+#include <semaphore.h>   // For sem_init, sem_wait, sem_post
+#include <stdatomic.h>   // For atomic_* operations
+#include <stdint.h>      // For uint64_t
+#include <stdio.h>       // For printf, perror
+#include <stdlib.h>      // For exit, atoi
+#include <time.h>        // For clock_gettime
+#include <unistd.h>      // For fork, read, write
+
+// The same workloads over five ways to block a process:
+//
+// - SysV semaphores (semop), as in semaphores.c: a system call for every down() and up()
+// - raw futexes: an atomic counter in shared memory; the kernel is only asked to sleep or
+//   wake when a process actually has to wait
+// - POSIX sem_t placed in shared memory (sem_init with pshared = 1), futex-based in glibc
+// - eventfd in semaphore mode, inherited across fork: a read() or write() per operation
+// - process-shared pthreads: a mutex and condition variable for ping-pong, and the plain
+//   mutex for the lock
+//
+// "ping-pong" hands a token back and forth between two processes (handoff latency), and
+// "contended" has 1..N processes increment a shared counter under a lock (throughput).
+// Each primitive is used as a counting semaphore with down() and up(), except that the
+// lock for pthreads is pthread_mutex_lock/unlock itself: a semaphore built from a mutex and
+// a condition variable would take the mutex twice per increment and not measure the mutex.
+// Usage: semaphores_benchmark [max processes]
+
+#define LOCK 0 // Semaphore indexes: the lock starts at 1, the ping-pong pair at 0
+#define PING 1
+#define PONG 2
+
+struct pt_sem {
+    pthread_mutex_t mutex;
+    pthread_cond_t nonzero;
+    int value;
+};
+
+struct futex_sem {
+    _Alignas(64) _Atomic int value;
+    _Atomic int waiters;
+};
+
+struct shared {
+    struct futex_sem futexes[3];
+    sem_t sems[3];
+    struct pt_sem pts[3];
+    _Alignas(64) long counter;
+};
+
+struct shared *sh;
+int semid;
+int efds[3];
+
+union semun { int val; }; // Union for semctl arguments
+
+// SysV semaphores
+void sysv_down(int i) {
+    struct sembuf op = {i, -1, 0};
+    if (semop(semid, &op, 1) == -1) {
+        perror("down failed");
+        exit(1);
+    }
+}
+
+void sysv_up(int i) {
+    struct sembuf op = {i, 1, 0};
+    if (semop(semid, &op, 1) == -1) {
+        perror("up failed");
+        exit(1);
+    }
+}
+
+// Raw futexes: sleep only while the value is 0, wake only if someone sleeps
+long futex(_Atomic int *addr, int op, int val) {
+    return syscall(SYS_futex, addr, op, val, NULL, NULL, 0);
+}
+
+void futex_down(int i) {
+    struct futex_sem *f = &sh->futexes[i];
+    for (;;) {
+        int v = atomic_load(&f->value);
+        if (v > 0) {
+            if (atomic_compare_exchange_weak(&f->value, &v, v - 1))
+                return;
+            continue;
+        }
+        atomic_fetch_add(&f->waiters, 1);
+        futex(&f->value, FUTEX_WAIT, 0); // Returns at once if the value is no longer 0
+        atomic_fetch_sub(&f->waiters, 1);
+    }
+}
+
+void futex_up(int i) {
+    struct futex_sem *f = &sh->futexes[i];
+    atomic_fetch_add(&f->value, 1);
+    if (atomic_load(&f->waiters) > 0)
+        futex(&f->value, FUTEX_WAKE, 1);
+}
+
+// POSIX semaphores in shared memory
+void posix_down(int i) {
+    if (sem_wait(&sh->sems[i]) == -1) {
+        perror("sem_wait failed");
+        exit(1);
+    }
+}
+
+void posix_up(int i) {
+    if (sem_post(&sh->sems[i]) == -1) {
+        perror("sem_post failed");
+        exit(1);
+    }
+}
+
+// eventfd in EFD_SEMAPHORE mode: read() takes 1, write() adds
+void eventfd_down(int i) {
+    uint64_t one;
+    if (read(efds[i], &one, sizeof(one)) != sizeof(one)) {
+        perror("eventfd read failed");
+        exit(1);
+    }
+}
+
+void eventfd_up(int i) {
+    uint64_t one = 1;
+    if (write(efds[i], &one, sizeof(one)) != sizeof(one)) {
+        perror("eventfd write failed");
+        exit(1);
+    }
+}
+
+// Process-shared pthread mutex + condition variable (ping-pong)
+void pthread_down(int i) {
+    struct pt_sem *p = &sh->pts[i];
+    pthread_mutex_lock(&p->mutex);
+    while (p->value == 0)
+        pthread_cond_wait(&p->nonzero, &p->mutex);
+    p->value--;
+    pthread_mutex_unlock(&p->mutex);
+}
+
+void pthread_up(int i) {
+    struct pt_sem *p = &sh->pts[i];
+    pthread_mutex_lock(&p->mutex);
+    p->value++;
+    pthread_cond_signal(&p->nonzero);
+    pthread_mutex_unlock(&p->mutex);
+}
+
+// Process-shared pthread mutex on its own (the contended lock)
+void pthread_lock(void) {
+    pthread_mutex_lock(&sh->pts[LOCK].mutex);
+}
+
+void pthread_unlock(void) {
+    pthread_mutex_unlock(&sh->pts[LOCK].mutex);
+}
+
+struct primitive {
+    const char *name;
+    void (*down)(int i);
+    void (*up)(int i);
+    void (*lock)(void);   // Used instead of down(LOCK)/up(LOCK) when set
+    void (*unlock)(void);
+};
+
+const struct primitive primitives[] = {
+    {"semop",   sysv_down,    sysv_up,    NULL,         NULL},
+    {"futex",   futex_down,   futex_up,   NULL,         NULL},
+    {"sem_t",   posix_down,   posix_up,   NULL,         NULL},
+    {"eventfd", eventfd_down, eventfd_up, NULL,         NULL},
+    {"pthread", pthread_down, pthread_up, pthread_lock, pthread_unlock},
+};
+#define NUM_PRIMITIVES (int)(sizeof(primitives) / sizeof(primitives[0]))
+
+// Function to (re)set every implementation: the lock to 1, PING and PONG to 0
+void reset(void) {
+    pthread_mutexattr_t ma;
+    pthread_condattr_t ca;
+    pthread_mutexattr_init(&ma);
+    pthread_mutexattr_setpshared(&ma, PTHREAD_PROCESS_SHARED);
+    pthread_condattr_init(&ca);
+    pthread_condattr_setpshared(&ca, PTHREAD_PROCESS_SHARED);
+    for (int i = 0; i < 3; i++) {
+        int value = i == LOCK;
+        union semun arg = {value};
+        if (semctl(semid, i, SETVAL, arg) == -1) {
+            perror("semctl failed");
+            exit(1);
+        }
+        atomic_store(&sh->futexes[i].value, value);
+        atomic_store(&sh->futexes[i].waiters, 0);
+        if (sem_init(&sh->sems[i], 1, value) == -1) { // pshared = 1: between processes
+            perror("sem_init failed");
+            exit(1);
+        }
+        if (efds[i] > 0)
+            close(efds[i]);
+        efds[i] = eventfd(value, EFD_SEMAPHORE);
+        if (efds[i] == -1) {
+            perror("eventfd failed");
+            exit(1);
+        }
+        pthread_mutex_init(&sh->pts[i].mutex, &ma);
+        pthread_cond_init(&sh->pts[i].nonzero, &ca);
+        sh->pts[i].value = value;
+    }
+    pthread_mutexattr_destroy(&ma);
+    pthread_condattr_destroy(&ca);
+    sh->counter = 0;
+}
+
+double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+void spawn(void (*body)(const struct primitive *, long), const struct primitive *p, long n) {
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == -1) {
+        perror("fork failed");
+        exit(1);
+    }
+    if (pid == 0) {
+        body(p, n);
+        exit(0);
+    }
+}
+
+void wait_all(int children) {
+    for (int c = 0; c < children; c++) {
+        if (wait(NULL) == -1) {
+            perror("wait failed");
+            exit(1);
+        }
+    }
+}
+
+void ponger(const struct primitive *p, long n) {
+    for (long r = 0; r < n; r++) {
+        p->down(PING);
+        p->up(PONG);
+    }
+}
+
+// Function to measure a one-way handoff: ns per half round trip
+double ping_pong(const struct primitive *p, long n) {
+    reset();
+    spawn(ponger, p, n);
+    double start = now_sec();
+    for (long r = 0; r < n; r++) {
+        p->up(PING);
+        p->down(PONG);
+    }
+    double elapsed = now_sec() - start;
+    wait_all(1);
+    return elapsed * 1e9 / (2 * n);
+}
+
+void incrementer(const struct primitive *p, long n) {
+    for (long r = 0; r < n; r++) {
+        if (p->lock) {
+            p->lock();
+            sh->counter++;
+            p->unlock();
+        } else {
+            p->down(LOCK);
+            sh->counter++;
+            p->up(LOCK);
+        }
+    }
+}
+
+// Function to measure lock throughput with `procs` processes: millions of increments per second
+double contended(const struct primitive *p, int procs, long n) {
+    reset();
+    double start = now_sec();
+    for (int c = 0; c < procs; c++)
+        spawn(incrementer, p, n);
+    wait_all(procs);
+    double elapsed = now_sec() - start;
+    if (sh->counter != procs * n) {
+        fprintf(stderr, "%s: lost updates (%ld of %ld)\n", p->name, sh->counter, procs * n);
+        exit(1);
+    }
+    return procs * n / elapsed / 1e6;
+}
+
+int main(int argc, char *argv[]) {
+    int max_procs = argc > 1 ? atoi(argv[1]) : 4;
+    if (max_procs < 1) {
+        fprintf(stderr, "need at least one process\n");
+        exit(1);
+    }
+    int shmid = shmget(IPC_PRIVATE, sizeof(struct shared), IPC_CREAT | 0666);
+    if (shmid == -1) {
+        perror("shmget failed");
+        exit(1);
+    }
+    sh = shmat(shmid, NULL, 0); // Attached before fork: children inherit it
+    if (sh == (void *)-1) {
+        perror("shmat failed");
+        exit(1);
+    }
+    semid = semget(IPC_PRIVATE, 3, IPC_CREAT | 0666);
+    if (semid == -1) {
+        perror("semget failed");
+        exit(1);
+    }
+
+    long n = 50000;
+    printf("%-22s", "");
+    for (int k = 0; k < NUM_PRIMITIVES; k++)
+        printf("%10s", primitives[k].name);
+    printf("\n%-22s", "ping-pong (ns/handoff)");
+    for (int k = 0; k < NUM_PRIMITIVES; k++)
+        printf("%10.0f", ping_pong(&primitives[k], n));
+    printf("\n");
+    for (int procs = 1; procs <= max_procs; procs *= 2) {
+        printf("contended, %2d proc%s   ", procs, procs > 1 ? "s" : " ");
+        for (int k = 0; k < NUM_PRIMITIVES; k++)
+            printf("%10.2f", contended(&primitives[k], procs, 4 * n / procs));
+        printf("   (M ops/s)\n");
+    }
+    printf("pthread: mutex + condition variable for ping-pong, pthread_mutex_lock/unlock when contended\n");
+
+    if (shmdt(sh) == -1) {
+        perror("shmdt failed");
+        exit(1);
+    }
+    if (shmctl(shmid, IPC_RMID, NULL) == -1) {
+        perror("Cleaning up (shmctl) failed");
+        exit(1);
+    }
+    if (semctl(semid, 0, IPC_RMID) == -1) {
+        perror("Cleaning up (semctl) failed");
+        exit(1);
+    }
+    return 0;
+}
@@ -0,0 +1,379 @@
+#include <sys/types.h> // For pid_t
+#include <sys/ipc.h>   // For IPC_PRIVATE, etc.
+#include <sys/shm.h>   // For shared memory functions
+#include <sys/sem.h>   // For semaphore functions
+#include <sys/wait.h>  // For waitpid
+#include <errno.h>     // For errno, EAGAIN
+#include <stdatomic.h> // For atomic_* operations
+#include <stdint.h>    // For uint64_t
+#include <stdio.h>     // For printf, perror
+#include <string.h>    // For strcmp, memset
+#include <stdlib.h>    // For exit
+#include <time.h>      // For clock_gettime
+#include <unistd.h>    // For fork, getpid, usleep
+
+// A contention profiler for SysV semaphores used as locks.
+//
+// down() in semaphores.c gives no hint of how long it waited. prof_down() and prof_up()
+// wrap the same semop() calls and record, per semaphore: how often it was taken, how often
+// the caller had to wait (a first semop with IPC_NOWAIT failed), histograms of wait and
+// hold times, and which processes waited and held longest. The counters live in a shared
+// memory segment, so every process adds to one profile.
+//
+// A sampler process also polls the kernel's view every millisecond with semctl: GETNCNT
+// (processes blocked in down), GETZCNT (blocked waiting for zero) and GETPID (the last
+// process to operate on it). The report ranks the semaphores by total time spent waiting.
+//
+// Usage: semaphores_profiler [off]   ("off" runs the same workload with plain semop calls)
+
+#define MAX_SEMS 4
+#define BUCKETS 16    // Histogram buckets: < 1 us, 1-2 us, 2-4 us, ... >= 16 ms
+#define MAX_PIDS 16
+
+struct pid_stat {
+    _Atomic int pid;
+    _Atomic uint64_t ns, count;
+};
+
+struct sem_profile {
+    char name[16];
+    _Atomic uint64_t acquisitions, contended, wait_ns, max_wait_ns, hold_ns;
+    _Atomic uint64_t wait_hist[BUCKETS], hold_hist[BUCKETS];
+    struct pid_stat waiters[MAX_PIDS], holders[MAX_PIDS];
+    // From the sampler
+    _Atomic uint64_t samples, ncnt_sum, ncnt_max, zcnt_sum;
+    struct pid_stat last_ops[MAX_PIDS];     // count = samples in which this pid operated last
+};
+
+struct profile {
+    int semid, nsems;
+    _Atomic int stop;
+    _Atomic uint64_t operations;            // Counted with or without profiling
+    struct sem_profile sems[MAX_SEMS];
+};
+
+struct profile *prof;      // NULL: profiling off
+uint64_t acquired_at[MAX_SEMS]; // Per process: when we took each semaphore
+
+uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+int bucket(uint64_t ns) {
+    int b = 0;
+    for (uint64_t us = ns / 1000; us > 0 && b < BUCKETS - 1; us >>= 1)
+        b++;
+    return b;
+}
+
+// Function to find (or claim) the entry for `pid` in a small table
+struct pid_stat *pid_entry(struct pid_stat *table, int pid) {
+    for (int i = 0; i < MAX_PIDS; i++) {
+        int seen = atomic_load(&table[i].pid);
+        if (seen == pid)
+            return &table[i];
+        if (seen == 0 && atomic_compare_exchange_strong(&table[i].pid, &seen, pid))
+            return &table[i];
+        if (seen == pid) // Claimed for the same pid in the meantime
+            return &table[i];
+    }
+    return NULL; // Table full: not counted per pid
+}
+
+void update_max(_Atomic uint64_t *max, uint64_t value) {
+    uint64_t seen = atomic_load(max);
+    while (value > seen && !atomic_compare_exchange_weak(max, &seen, value))
+        ;
+}
+
+// Function to perform a semaphore "down" (decrement) operation, recording the wait
+void prof_down(int semid, int sem) {
+    struct sembuf op = {sem, -1, IPC_NOWAIT};
+    if (!prof) {
+        op.sem_flg = 0;
+        if (semop(semid, &op, 1) == -1) {
+            perror("down failed");
+            exit(1);
+        }
+        return;
+    }
+    uint64_t start = now_ns();
+    int contended = 0;
+    if (semop(semid, &op, 1) == -1) {
+        if (errno != EAGAIN) {
+            perror("down failed");
+            exit(1);
+        }
+        contended = 1;
+        op.sem_flg = 0;
+        if (semop(semid, &op, 1) == -1) {
+            perror("down failed");
+            exit(1);
+        }
+    }
+    uint64_t now = now_ns(), waited = now - start;
+    struct sem_profile *p = &prof->sems[sem];
+    atomic_fetch_add_explicit(&p->acquisitions, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&p->wait_hist[bucket(waited)], 1, memory_order_relaxed);
+    if (contended) {
+        atomic_fetch_add_explicit(&p->contended, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&p->wait_ns, waited, memory_order_relaxed);
+        update_max(&p->max_wait_ns, waited);
+        struct pid_stat *w = pid_entry(p->waiters, getpid());
+        if (w) {
+            atomic_fetch_add_explicit(&w->ns, waited, memory_order_relaxed);
+            atomic_fetch_add_explicit(&w->count, 1, memory_order_relaxed);
+        }
+    }
+    acquired_at[sem] = now;
+}
+
+// Function to perform a semaphore "up" (increment) operation, recording the hold time
+void prof_up(int semid, int sem) {
+    if (prof) {
+        uint64_t held = now_ns() - acquired_at[sem];
+        struct sem_profile *p = &prof->sems[sem];
+        atomic_fetch_add_explicit(&p->hold_ns, held, memory_order_relaxed);
+        atomic_fetch_add_explicit(&p->hold_hist[bucket(held)], 1, memory_order_relaxed);
+        struct pid_stat *h = pid_entry(p->holders, getpid());
+        if (h) {
+            atomic_fetch_add_explicit(&h->ns, held, memory_order_relaxed);
+            atomic_fetch_add_explicit(&h->count, 1, memory_order_relaxed);
+        }
+    }
+    struct sembuf op = {sem, 1, 0};
+    if (semop(semid, &op, 1) == -1) {
+        perror("up failed");
+        exit(1);
+    }
+}
+
+// The sampler: polls the kernel's counters until told to stop
+void sample(void) {
+    while (!atomic_load(&prof->stop)) {
+        for (int s = 0; s < prof->nsems; s++) {
+            struct sem_profile *p = &prof->sems[s];
+            int ncnt = semctl(prof->semid, s, GETNCNT), zcnt = semctl(prof->semid, s, GETZCNT);
+            int last = semctl(prof->semid, s, GETPID);
+            if (ncnt == -1 || zcnt == -1 || last == -1) {
+                perror("semctl failed");
+                exit(1);
+            }
+            atomic_fetch_add(&p->samples, 1);
+            atomic_fetch_add(&p->ncnt_sum, ncnt);
+            atomic_fetch_add(&p->zcnt_sum, zcnt);
+            update_max(&p->ncnt_max, ncnt);
+            struct pid_stat *l = last ? pid_entry(p->last_ops, last) : NULL;
+            if (l)
+                atomic_fetch_add(&l->count, 1);
+        }
+        usleep(1000);
+    }
+}
+
+// Function to estimate a percentile from a histogram: the upper edge of its bucket, in us
+double percentile(_Atomic uint64_t *hist, double q) {
+    uint64_t total = 0, seen = 0;
+    for (int b = 0; b < BUCKETS; b++)
+        total += hist[b];
+    for (int b = 0; b < BUCKETS; b++) {
+        seen += hist[b];
+        if (total && seen >= q * total)
+            return (double)(1ULL << b);
+    }
+    return 0;
+}
+
+void print_histogram(const char *title, _Atomic uint64_t *hist) {
+    uint64_t max = 1;
+    for (int b = 0; b < BUCKETS; b++)
+        max = hist[b] > max ? hist[b] : max;
+    printf("    %s:\n", title);
+    for (int b = 0; b < BUCKETS; b++) {
+        if (!hist[b])
+            continue;
+        char range[24];
+        if (b == 0)
+            snprintf(range, sizeof(range), "< 1 us");
+        else
+            snprintf(range, sizeof(range), "%llu-%llu us", 1ULL << (b - 1), 1ULL << b);
+        printf("      %-14s %8lu ", range, (unsigned long)hist[b]);
+        for (int i = 0; i < (int)(40 * hist[b] / max) + 1; i++)
+            putchar('#');
+        printf("\n");
+    }
+}
+
+// Function to print the three pids with the most time in a table
+void print_top(const char *title, struct pid_stat *table, const char *what) {
+    int shown[3] = {0};
+    printf("    %s:", title);
+    for (int k = 0; k < 3; k++) {
+        struct pid_stat *best = NULL;
+        for (int i = 0; i < MAX_PIDS; i++) {
+            struct pid_stat *e = &table[i];
+            if (e->pid > 0 && e->pid != shown[0] && e->pid != shown[1] && (!best || e->ns > best->ns))
+                best = e;
+        }
+        if (!best)
+            break;
+        shown[k] = best->pid;
+        printf(" pid %d (%.1f ms in %lu %s)", best->pid, best->ns / 1e6, (unsigned long)best->count, what);
+    }
+    printf("\n");
+}
+
+void report(void) {
+    int order[MAX_SEMS];
+    for (int s = 0; s < prof->nsems; s++) { // Rank by total wait, worst first
+        order[s] = s;
+        for (int i = s; i > 0 && prof->sems[order[i]].wait_ns > prof->sems[order[i - 1]].wait_ns; i--) {
+            int t = order[i];
+            order[i] = order[i - 1];
+            order[i - 1] = t;
+        }
+    }
+    for (int k = 0; k < prof->nsems; k++) {
+        struct sem_profile *p = &prof->sems[order[k]];
+        uint64_t n = p->acquisitions ? p->acquisitions : 1, samples = p->samples ? p->samples : 1;
+        printf("\nSemaphore %d \"%s\": %lu acquisitions, %.1f%% had to wait, %.1f ms waited in total\n",
+               order[k], p->name, (unsigned long)p->acquisitions, 100.0 * p->contended / n, p->wait_ns / 1e6);
+        printf("    wait p50 < %.0f us, p99 < %.0f us, max %.0f us; hold avg %.1f us, p99 < %.0f us\n",
+               percentile(p->wait_hist, 0.5), percentile(p->wait_hist, 0.99), p->max_wait_ns / 1e3,
+               p->hold_ns / 1e3 / n, percentile(p->hold_hist, 0.99));
+        printf("    sampled: %.2f blocked in down on average (max %lu), %.2f waiting for zero\n",
+               (double)p->ncnt_sum / samples, (unsigned long)p->ncnt_max, (double)p->zcnt_sum / samples);
+        print_top("top waiters", p->waiters, "waits");
+        print_top("top holders", p->holders, "holds");
+        struct pid_stat *last = NULL;
+        for (int i = 0; i < MAX_PIDS; i++)
+            if (p->last_ops[i].pid && (!last || p->last_ops[i].count > last->count))
+                last = &p->last_ops[i];
+        if (last)
+            printf("    most often last to operate (GETPID): pid %d\n", last->pid);
+        print_histogram("wait times", p->wait_hist);
+        print_histogram("hold times", p->hold_hist);
+    }
+}
+
+// The workload: three locks, one of which a single process holds for long stretches
+uint64_t operations; // Per process
+
+void worker(int semid, int w, double seconds) {
+    uint64_t x = w + 1, end = now_ns() + seconds * 1e9;
+    volatile uint64_t sink = 0;
+    while (now_ns() < end) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        int sem = x % 10 < 6 ? 0 : x % 10 < 9 ? 1 : 2;
+        prof_down(semid, sem);
+        long work = sem == 1 && w == 2 ? 400000 : 2000; // Worker 2 holds "journal" far too long
+        for (long i = 0; i < work; i++)
+            sink += i;
+        prof_up(semid, sem);
+        for (long i = 0; i < 5000; i++)
+            sink += i;
+        operations++;
+    }
+}
+
+union semun { int val; }; // Union for semctl arguments
+
+int main(int argc, char *argv[]) {
+    int profiling = !(argc > 1 && strcmp(argv[1], "off") == 0);
+    int nsems = 3, workers = 4;
+    const char *names[] = {"config", "journal", "stats"};
+    int semid = semget(IPC_PRIVATE, nsems, IPC_CREAT | 0666);
+    if (semid == -1) {
+        perror("semget failed");
+        exit(1);
+    }
+    for (int s = 0; s < nsems; s++) {
+        union semun arg = {1}; // Locks: start free
+        if (semctl(semid, s, SETVAL, arg) == -1) {
+            perror("semctl failed");
+            exit(1);
+        }
+    }
+    int shmid = shmget(IPC_PRIVATE, sizeof(struct profile), IPC_CREAT | 0666);
+    if (shmid == -1) {
+        perror("shmget failed");
+        exit(1);
+    }
+    struct profile *shared = shmat(shmid, NULL, 0); // Attached before fork: children inherit it
+    if (shared == (void *)-1) {
+        perror("shmat failed");
+        exit(1);
+    }
+    memset(shared, 0, sizeof(*shared));
+    shared->semid = semid;
+    shared->nsems = nsems;
+    for (int s = 0; s < nsems; s++)
+        snprintf(shared->sems[s].name, sizeof(shared->sems[s].name), "%s", names[s]);
+    if (profiling)
+        prof = shared;
+
+    pid_t sampler = -1;
+    if (profiling) {
+        fflush(stdout);
+        sampler = fork();
+        if (sampler == -1) {
+            perror("fork failed");
+            exit(1);
+        }
+        if (sampler == 0) {
+            sample();
+            exit(0);
+        }
+    }
+    uint64_t start = now_ns();
+    for (int w = 0; w < workers; w++) {
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid == -1) {
+            perror("fork failed");
+            exit(1);
+        }
+        if (pid == 0) {
+            printf("Worker %d is pid %d\n", w, getpid());
+            fflush(stdout);
+            worker(semid, w, 1.0);
+            atomic_fetch_add(&shared->operations, operations);
+            exit(0);
+        }
+    }
+    for (int w = 0; w < workers; w++) {
+        if (wait(NULL) == -1) {
+            perror("wait failed");
+            exit(1);
+        }
+    }
+    uint64_t elapsed = now_ns() - start;
+    if (profiling) {
+        atomic_store(&shared->stop, 1);
+        if (waitpid(sampler, NULL, 0) == -1) {
+            perror("waitpid failed");
+            exit(1);
+        }
+    }
+    printf("%lu acquisitions in %.2f s %s profiling (compare with \"%s\" for the overhead)\n",
+           (unsigned long)atomic_load(&shared->operations), elapsed / 1e9, profiling ? "with" : "without",
+           profiling ? "off" : "on");
+    if (profiling)
+        report();
+
+    if (shmdt(shared) == -1) {
+        perror("shmdt failed");
+        exit(1);
+    }
+    if (shmctl(shmid, IPC_RMID, NULL) == -1) {
+        perror("Cleaning up (shmctl) failed");
+        exit(1);
+    }
+    if (semctl(semid, 0, IPC_RMID) == -1) {
+        perror("Cleaning up (semctl) failed");
+        exit(1);
+    }
+    return 0;
+}
@@ -0,0 +1,251 @@
+#include <sys/types.h> // For pid_t
+#include <sys/ipc.h>   // For IPC_PRIVATE, etc.
+#include <sys/shm.h>   // For shared memory functions
+#include <sys/sem.h>   // For semaphore functions
+#include <sys/wait.h>  // For wait
+#include <stdatomic.h> // For atomic_* operations
+#include <stdint.h>    // For uint64_t
+#include <stdio.h>     // For printf, perror
+#include <stdlib.h>    // For exit, atoi
+#include <time.h>      // For clock_gettime
+#include <unistd.h>    // For fork
+
+// A reader-writer lock for processes sharing memory.
+//
+// semaphores.c uses one semaphore as a signal; used as a lock, it lets one process in at a
+// time even when they all only read. This lock admits any number of readers, or one writer.
+//
+// Its state is one 64-bit word in shared memory: active readers, a writer bit, and how many
+// readers and writers are waiting. Taking or releasing an uncontended lock is a single
+// compare-and-swap, with no system call. Only a process that must wait goes to the kernel:
+// it counts itself as waiting and sleeps in semop() on one of two semaphores in a set, one
+// for readers and one for writers. The process that releases the lock decides who goes next.
+// It updates the state word on their behalf (they already own the lock when they wake up),
+// then adds to their semaphore: +1 for a writer, +n to admit all n waiting readers at once.
+//
+// With PREFER_WRITERS, new readers queue behind a waiting writer and a writer that unlocks
+// hands over to the next writer first, so a steady stream of readers can't starve writers.
+// PREFER_READERS maximizes read throughput instead, and can starve them.
+
+enum preference { PREFER_READERS, PREFER_WRITERS };
+
+#define READER_SEM 0
+#define WRITER_SEM 1
+
+// Fields of the state word, 16 bits each
+#define READERS(s)         ((s) & 0xFFFF)
+#define WRITER(s)          (((s) >> 16) & 1)
+#define WAITING_READERS(s) (((s) >> 32) & 0xFFFF)
+#define WAITING_WRITERS(s) (((s) >> 48) & 0xFFFF)
+#define ONE_READER         1ULL
+#define WRITER_BIT         (1ULL << 16)
+#define ONE_WAITING_READER (1ULL << 32)
+#define ONE_WAITING_WRITER (1ULL << 48)
+
+struct rwlock {
+    _Alignas(64) _Atomic uint64_t state;
+    int semid;             // READER_SEM and WRITER_SEM, both starting at 0
+    enum preference preference;
+};
+
+// Function to add `n` to (or take 1 from) a semaphore in the set
+void sem_add(int semid, int sem, int n) {
+    struct sembuf op = {sem, n, 0};
+    if (semop(semid, &op, 1) == -1) {
+        perror(n > 0 ? "up failed" : "down failed");
+        exit(1);
+    }
+}
+
+void read_lock(struct rwlock *l) {
+    uint64_t s = atomic_load(&l->state), new;
+    int wait;
+    do {
+        wait = WRITER(s) || (l->preference == PREFER_WRITERS && WAITING_WRITERS(s));
+        new = s + (wait ? ONE_WAITING_READER : ONE_READER);
+    } while (!atomic_compare_exchange_weak(&l->state, &s, new));
+    if (wait)
+        sem_add(l->semid, READER_SEM, -1); // Whoever wakes us has counted us as a reader
+}
+
+// Function to pass the lock on after the last holder left; `s` is the state without it
+uint64_t hand_over(struct rwlock *l, uint64_t s, int *wake_readers, int *wake_writer) {
+    *wake_readers = 0;
+    *wake_writer = 0;
+    int writers_first = l->preference == PREFER_WRITERS || WAITING_READERS(s) == 0;
+    if (WAITING_WRITERS(s) && writers_first) {
+        *wake_writer = 1;
+        return s - ONE_WAITING_WRITER + WRITER_BIT;
+    }
+    if (WAITING_READERS(s)) {
+        *wake_readers = WAITING_READERS(s);
+        return s - *wake_readers * ONE_WAITING_READER + *wake_readers * ONE_READER;
+    }
+    return s;
+}
+
+void wake(struct rwlock *l, int readers, int writer) {
+    if (readers)
+        sem_add(l->semid, READER_SEM, readers);
+    if (writer)
+        sem_add(l->semid, WRITER_SEM, 1);
+}
+
+void read_unlock(struct rwlock *l) {
+    uint64_t s = atomic_load(&l->state), new;
+    int writer;
+    do {
+        new = s - ONE_READER;
+        writer = 0;
+        if (READERS(new) == 0 && WAITING_WRITERS(new)) { // Only a writer can be waiting on readers
+            new = new - ONE_WAITING_WRITER + WRITER_BIT;
+            writer = 1;
+        }
+    } while (!atomic_compare_exchange_weak(&l->state, &s, new));
+    wake(l, 0, writer);
+}
+
+void write_lock(struct rwlock *l) {
+    uint64_t s = atomic_load(&l->state), new;
+    int wait;
+    do {
+        wait = WRITER(s) || READERS(s);
+        new = s + (wait ? ONE_WAITING_WRITER : WRITER_BIT);
+    } while (!atomic_compare_exchange_weak(&l->state, &s, new));
+    if (wait)
+        sem_add(l->semid, WRITER_SEM, -1);
+}
+
+void write_unlock(struct rwlock *l) {
+    uint64_t s = atomic_load(&l->state), new;
+    int readers, writer;
+    do {
+        new = hand_over(l, s - WRITER_BIT, &readers, &writer);
+    } while (!atomic_compare_exchange_weak(&l->state, &s, new));
+    wake(l, readers, writer);
+}
+
+// The protected data: a small read-mostly cache, consistent when every entry is equal
+#define ENTRIES 256
+
+struct shared {
+    struct rwlock lock;
+    _Alignas(64) uint64_t entries[ENTRIES];
+    _Atomic long reads, writes, torn;
+    _Atomic uint64_t write_wait_ns, max_write_wait_ns;
+};
+
+double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Function to run `procs` processes for half a second, 1 in 20 operations a write
+void run(struct shared *sh, int procs, int exclusive) {
+    atomic_store(&sh->reads, 0);
+    atomic_store(&sh->writes, 0);
+    atomic_store(&sh->write_wait_ns, 0);
+    atomic_store(&sh->max_write_wait_ns, 0);
+    for (int p = 0; p < procs; p++) {
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid == -1) {
+            perror("fork failed");
+            exit(1);
+        }
+        if (pid != 0)
+            continue;
+        uint64_t x = p + 1;
+        long reads = 0, writes = 0;
+        for (double end = now_sec() + 0.5; now_sec() < end;) {
+            x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+            if (x % 20 == 0) {
+                double start = now_sec();
+                write_lock(&sh->lock);
+                uint64_t waited = (now_sec() - start) * 1e9, max = atomic_load(&sh->max_write_wait_ns);
+                while (waited > max && !atomic_compare_exchange_weak(&sh->max_write_wait_ns, &max, waited))
+                    ;
+                atomic_fetch_add(&sh->write_wait_ns, waited);
+                for (int i = 0; i < ENTRIES; i++)
+                    sh->entries[i]++;
+                write_unlock(&sh->lock);
+                writes++;
+            } else {
+                if (exclusive) // The one-mutex baseline: readers exclude each other too
+                    write_lock(&sh->lock);
+                else
+                    read_lock(&sh->lock);
+                uint64_t first = sh->entries[0];
+                for (int i = 1; i < ENTRIES; i++)
+                    if (sh->entries[i] != first)
+                        atomic_fetch_add(&sh->torn, 1);
+                if (exclusive)
+                    write_unlock(&sh->lock);
+                else
+                    read_unlock(&sh->lock);
+                reads++;
+            }
+        }
+        atomic_fetch_add(&sh->reads, reads);
+        atomic_fetch_add(&sh->writes, writes);
+        exit(0);
+    }
+    for (int p = 0; p < procs; p++) {
+        if (wait(NULL) == -1) {
+            perror("wait failed");
+            exit(1);
+        }
+    }
+}
+
+// Usage: semaphores_rwlock [processes]
+int main(int argc, char *argv[]) {
+    int procs = argc > 1 ? atoi(argv[1]) : 4;
+    if (procs < 1) {
+        fprintf(stderr, "need at least one process\n");
+        exit(1);
+    }
+    int shmid = shmget(IPC_PRIVATE, sizeof(struct shared), IPC_CREAT | 0666);
+    if (shmid == -1) {
+        perror("shmget failed");
+        exit(1);
+    }
+    struct shared *sh = shmat(shmid, NULL, 0); // Attached before fork: children inherit it
+    if (sh == (void *)-1) {
+        perror("shmat failed");
+        exit(1);
+    }
+    sh->lock.semid = semget(IPC_PRIVATE, 2, IPC_CREAT | 0666); // New semaphores start at 0
+    if (sh->lock.semid == -1) {
+        perror("semget failed");
+        exit(1);
+    }
+
+    printf("%d processes, 95%% reads:\n", procs);
+    const char *names[] = {"one mutex", "rwlock, prefer readers", "rwlock, prefer writers"};
+    for (int mode = 0; mode < 3; mode++) {
+        sh->lock.preference = mode == 2 ? PREFER_WRITERS : PREFER_READERS;
+        run(sh, procs, mode == 0);
+        long writes = atomic_load(&sh->writes);
+        printf("  %-24s %9.0f reads/s %8.0f writes/s, write lock wait avg %6.1f us, max %7.1f us\n", names[mode],
+               atomic_load(&sh->reads) / 0.5, writes / 0.5,
+               writes ? atomic_load(&sh->write_wait_ns) / 1e3 / writes : 0.0, atomic_load(&sh->max_write_wait_ns) / 1e3);
+    }
+    long torn = atomic_load(&sh->torn);
+    printf("Reads that saw a half-written cache: %ld\n", torn);
+
+    if (semctl(sh->lock.semid, 0, IPC_RMID) == -1) {
+        perror("Cleaning up (semctl) failed");
+        exit(1);
+    }
+    if (shmdt(sh) == -1) {
+        perror("shmdt failed");
+        exit(1);
+    }
+    if (shmctl(shmid, IPC_RMID, NULL) == -1) {
+        perror("Cleaning up (shmctl) failed");
+        exit(1);
+    }
+    return torn != 0;
+}
@@ -0,0 +1,238 @@
+#define _GNU_SOURCE      // For semtimedop
+#include <sys/types.h>   // For pid_t
+#include <sys/ipc.h>     // For IPC_PRIVATE, etc.
+#include <sys/shm.h>     // For shared memory functions
+#include <sys/sem.h>     // For semaphore functions
+#include <sys/syscall.h> // For SYS_futex
+#include <sys/wait.h>    // For waitpid
+#include <linux/futex.h> // For FUTEX_WAIT_BITSET, FUTEX_WAKE
+#include <errno.h>       // For errno, EAGAIN, EINTR, ETIMEDOUT
+#include <signal.h>      // For raise, SIGKILL
+#include <stdatomic.h>   // For atomic_* operations
+#include <stdio.h>       // For printf, perror
+#include <stdlib.h>      // For exit
+#include <time.h>        // For clock_gettime
+#include <unistd.h>      // For fork
+
+// Semaphore waits with a deadline.
+//
+// down() in semaphores.c waits forever: if the process that should call up() crashes, the
+// waiter is stuck with it. down_timed() gives up at a deadline and returns TIMED_OUT.
+// There are two versions: one on a SysV semaphore with semtimedop(), and a faster one on a
+// count in shared memory that only calls futex() when it has to sleep.
+//
+// Deadlines are absolute (CLOCK_MONOTONIC) and propagate: budget_begin() can only shorten
+// the deadline in force, so a request that has 300 ms and calls a step that allows itself
+// one second still gives up after 300 ms in total, however many waits it makes on the way.
+
+enum wait_status { ACQUIRED, TIMED_OUT };
+
+// The deadline in force for this process (infinitely far away when no budget is set)
+struct timespec deadline = {-1, 0};
+
+struct timespec now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts;
+}
+
+double ms_since(struct timespec start) {
+    struct timespec t = now();
+    return (t.tv_sec - start.tv_sec) * 1e3 + (t.tv_nsec - start.tv_nsec) / 1e6;
+}
+
+// Function to allow at most `ms` more milliseconds; returns the previous deadline for budget_end
+struct timespec budget_begin(long ms) {
+    struct timespec saved = deadline, t = now();
+    t.tv_sec += ms / 1000;
+    t.tv_nsec += (ms % 1000) * 1000000;
+    if (t.tv_nsec >= 1000000000) {
+        t.tv_sec++;
+        t.tv_nsec -= 1000000000;
+    }
+    if (deadline.tv_sec < 0 || t.tv_sec < deadline.tv_sec ||
+        (t.tv_sec == deadline.tv_sec && t.tv_nsec < deadline.tv_nsec))
+        deadline = t;
+    return saved;
+}
+
+void budget_end(struct timespec saved) {
+    deadline = saved;
+}
+
+// Function to compute the time left until the deadline; returns 0 if it has passed
+int remaining(struct timespec *left) {
+    struct timespec t = now();
+    left->tv_sec = deadline.tv_sec - t.tv_sec;
+    left->tv_nsec = deadline.tv_nsec - t.tv_nsec;
+    if (left->tv_nsec < 0) {
+        left->tv_sec--;
+        left->tv_nsec += 1000000000;
+    }
+    return left->tv_sec >= 0;
+}
+
+union semun { int val; }; // Union for semctl arguments
+
+// Function to perform a semaphore "down" that gives up at the deadline (SysV version)
+enum wait_status down_timed(int semid) {
+    struct sembuf op = {0, -1, 0};
+    for (;;) {
+        struct timespec left;
+        if (deadline.tv_sec < 0) {
+            if (semop(semid, &op, 1) == 0)
+                return ACQUIRED;
+        } else {
+            if (!remaining(&left))
+                return TIMED_OUT;
+            if (semtimedop(semid, &op, 1, &left) == 0) // semtimedop takes a relative timeout
+                return ACQUIRED;
+            if (errno == EAGAIN)
+                return TIMED_OUT;
+        }
+        if (errno != EINTR) { // A signal: retry with whatever time is left
+            perror("down failed");
+            exit(1);
+        }
+    }
+}
+
+// Function to perform a semaphore "up" (increment) operation
+void up(int semid) {
+    struct sembuf op = {0, 1, 0};
+    if (semop(semid, &op, 1) == -1) {
+        perror("up failed");
+        exit(1);
+    }
+}
+
+// The fast path version: the count lives in shared memory
+struct fast_sem {
+    _Atomic int value;
+    _Atomic int waiters;
+};
+
+enum wait_status fast_down_timed(struct fast_sem *s) {
+    for (;;) {
+        int v = atomic_load(&s->value);
+        while (v > 0)
+            if (atomic_compare_exchange_weak(&s->value, &v, v - 1))
+                return ACQUIRED; // No system call when the count is positive
+        struct timespec left;
+        if (deadline.tv_sec >= 0 && !remaining(&left))
+            return TIMED_OUT;
+        atomic_fetch_add(&s->waiters, 1);
+        // FUTEX_WAIT_BITSET takes an absolute CLOCK_MONOTONIC deadline, no conversion needed
+        long rc = syscall(SYS_futex, &s->value, FUTEX_WAIT_BITSET, 0,
+                          deadline.tv_sec < 0 ? NULL : &deadline, NULL, FUTEX_BITSET_MATCH_ANY);
+        atomic_fetch_sub(&s->waiters, 1);
+        if (rc == -1 && errno == ETIMEDOUT)
+            return TIMED_OUT;
+    }
+}
+
+void fast_up(struct fast_sem *s) {
+    atomic_fetch_add(&s->value, 1);
+    if (atomic_load(&s->waiters) > 0)
+        syscall(SYS_futex, &s->value, FUTEX_WAKE, 1, NULL, NULL, 0);
+}
+
+// One step of a request: wait for a resource, allowing itself up to `ms`
+enum wait_status step(const char *name, int semid, struct fast_sem *reply, long ms) {
+    struct timespec start = now(), saved = budget_begin(ms);
+    enum wait_status st = semid >= 0 ? down_timed(semid) : fast_down_timed(reply);
+    budget_end(saved);
+    printf("  %-22s %-9s after %5.1f ms (allowed itself %ld ms)\n", name,
+           st == ACQUIRED ? "acquired" : "TIMED OUT", ms_since(start), ms);
+    return st;
+}
+
+int main() {
+    int semid = semget(IPC_PRIVATE, 1, IPC_CREAT | 0666);
+    if (semid == -1) {
+        perror("semget failed");
+        exit(1);
+    }
+    union semun arg = {1}; // A lock: starts free
+    if (semctl(semid, 0, SETVAL, arg) == -1) {
+        perror("semctl failed");
+        exit(1);
+    }
+    int shmid = shmget(IPC_PRIVATE, sizeof(struct fast_sem), IPC_CREAT | 0666);
+    if (shmid == -1) {
+        perror("shmget failed");
+        exit(1);
+    }
+    struct fast_sem *reply = shmat(shmid, NULL, 0); // Attached before fork: the child inherits it
+    if (reply == (void *)-1) {
+        perror("shmat failed");
+        exit(1);
+    }
+
+    // Child: a peer that takes the lock (without SEM_UNDO), replies once, then crashes
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == -1) {
+        perror("fork failed");
+        exit(1);
+    }
+    if (pid == 0) {
+        if (down_timed(semid) != ACQUIRED)
+            exit(1);
+        fast_up(reply);
+        raise(SIGKILL); // Dies holding the lock; the second reply never comes
+    }
+    if (waitpid(pid, NULL, 0) == -1) {
+        perror("waitpid failed");
+        exit(1);
+    }
+
+    // Parent: a worker serving a request with a 300 ms budget
+    printf("Request with a 300 ms budget:\n");
+    struct timespec start = now(), saved = budget_begin(300);
+    int ok = step("first reply (futex)", -1, reply, 1000) == ACQUIRED;
+    ok &= step("lock (semtimedop)", semid, NULL, 200) == TIMED_OUT;   // The dead peer holds it
+    ok &= step("second reply (futex)", -1, reply, 1000) == TIMED_OUT; // Gets what is left
+    budget_end(saved);
+    double total = ms_since(start);
+    printf("Request gave up after %.1f ms in total instead of waiting forever\n", total);
+    ok &= total < 350;
+
+    // Cost of an uncontended down/up pair with a deadline set
+    arg.val = 1;
+    if (semctl(semid, 0, SETVAL, arg) == -1) {
+        perror("semctl failed");
+        exit(1);
+    }
+    atomic_store(&reply->value, 1);
+    saved = budget_begin(10000);
+    long n = 200000;
+    struct timespec t0 = now();
+    for (long i = 0; i < n; i++) {
+        down_timed(semid);
+        up(semid);
+    }
+    double sysv = ms_since(t0) * 1e6 / n;
+    t0 = now();
+    for (long i = 0; i < n; i++) {
+        fast_down_timed(reply);
+        fast_up(reply);
+    }
+    double fast = ms_since(t0) * 1e6 / n;
+    budget_end(saved);
+    printf("Uncontended down+up: semtimedop %.0f ns, futex fast path %.0f ns\n", sysv, fast);
+
+    if (shmdt(reply) == -1) {
+        perror("shmdt failed");
+        exit(1);
+    }
+    if (shmctl(shmid, IPC_RMID, NULL) == -1) {
+        perror("Cleaning up (shmctl) failed");
+        exit(1);
+    }
+    if (semctl(semid, 0, IPC_RMID) == -1) {
+        perror("Cleaning up (semctl) failed");
+        exit(1);
+    }
+    return !ok;
+}
@@ -0,0 +1,234 @@
+#include <sys/types.h> // For pid_t
+#include <sys/ipc.h>   // For IPC_PRIVATE, etc.
+#include <sys/shm.h>   // For shared memory functions
+#include <sys/sem.h>   // For semaphore functions
+#include <sys/wait.h>  // For wait
+#include <stdatomic.h> // For atomic_* operations
+#include <stdint.h>    // For uint64_t, uint32_t
+#include <stdio.h>     // For printf, perror, snprintf
+#include <string.h>    // For memset
+#include <stdlib.h>    // For exit
+#include <unistd.h>    // For fork, getpid
+
+// A growable arena: a small header segment plus a chain of data segments ("extents").
+// Each new extent is twice as large as the previous one. Allocations are referenced
+// by (extent << 32 | offset), so they stay valid no matter where each process attaches.
+// Processes notice new extents through the generation counter in the header and attach
+// them lazily, the first time a reference into them is followed. The offset is 32 bits, so
+// extents stop doubling at MAX_EXTENT_SIZE and larger allocations are refused.
+
+#define MAX_EXTENTS 32
+#define INITIAL_SIZE 4096 // Sized for typical load; spikes grow the chain
+#define MAX_EXTENT_SIZE ((size_t)UINT32_MAX) // Every offset + size fits in 32 bits
+#define NULL_REF 0        // Extent 0 starts allocating at offset 16, so ref 0 is never used
+
+typedef uint64_t arena_ref;
+
+struct arena_header {
+    _Atomic uint32_t generation;  // Number of extents that exist
+    int shmids[MAX_EXTENTS];      // Segment ID of every extent
+    size_t sizes[MAX_EXTENTS];    // Size of every extent
+    _Atomic arena_ref top;        // Next free byte in the newest extent
+    _Atomic arena_ref list_head;  // Demo data: head of a shared linked list
+};
+
+struct arena {
+    int semid;                    // Serializes growth (allocation itself is lock-free)
+    int header_id;
+    struct arena_header *header;
+    uint32_t attached;            // How many extents this process has attached
+    char *base[MAX_EXTENTS];      // Where this process attached each extent
+};
+
+struct record {
+    arena_ref next;
+    pid_t writer;
+    char text[40];
+};
+
+union semun { int val; }; // Union for semctl arguments
+
+// Function to perform a semaphore "down" (decrement) operation
+void down(int semid) {
+    struct sembuf op = {0, -1, SEM_UNDO}; // Undone automatically if we die while growing
+    if (semop(semid, &op, 1) == -1) {
+        perror("down failed");
+        exit(1);
+    }
+}
+
+// Function to perform a semaphore "up" (increment) operation
+void up(int semid) {
+    struct sembuf op = {0, 1, SEM_UNDO};
+    if (semop(semid, &op, 1) == -1) {
+        perror("up failed");
+        exit(1);
+    }
+}
+
+void *attach(int shmid) {
+    void *shmaddr = shmat(shmid, NULL, 0);
+    if (shmaddr == (void *)-1) {
+        perror("shmat failed");
+        exit(1);
+    }
+    return shmaddr;
+}
+
+int create_extent(size_t size) {
+    int shmid = shmget(IPC_PRIVATE, size, IPC_CREAT | 0666);
+    if (shmid == -1) {
+        perror("shmget failed");
+        exit(1);
+    }
+    return shmid;
+}
+
+// Function to create the header, the growth semaphore and the first extent
+void arena_create(struct arena *a) {
+    a->header_id = create_extent(sizeof(struct arena_header));
+    a->header = attach(a->header_id);
+    memset(a->header, 0, sizeof(struct arena_header));
+    a->header->shmids[0] = create_extent(INITIAL_SIZE);
+    a->header->sizes[0] = INITIAL_SIZE;
+    atomic_store(&a->header->top, 16);
+    atomic_store(&a->header->generation, 1);
+    a->attached = 0;
+
+    a->semid = semget(IPC_PRIVATE, 1, IPC_CREAT | 0666);
+    if (a->semid == -1) {
+        perror("semget failed");
+        exit(1);
+    }
+    union semun arg = {1}; // Growth lock starts unlocked
+    if (semctl(a->semid, 0, SETVAL, arg) == -1) {
+        perror("semctl failed");
+        exit(1);
+    }
+}
+
+// Function to attach every extent created since this process last looked
+void arena_sync(struct arena *a) {
+    uint32_t generation = atomic_load_explicit(&a->header->generation, memory_order_acquire);
+    while (a->attached < generation) {
+        a->base[a->attached] = attach(a->header->shmids[a->attached]);
+        a->attached++;
+    }
+}
+
+// Function to turn a reference into a pointer, attaching new extents on demand
+void *arena_ptr(struct arena *a, arena_ref ref) {
+    uint32_t extent = (uint32_t)(ref >> 32);
+    if (extent >= a->attached)
+        arena_sync(a);
+    return a->base[extent] + (uint32_t)ref;
+}
+
+// Function to add an extent after `full`, unless another process already did
+void arena_grow(struct arena *a, uint32_t full, size_t need) {
+    struct arena_header *h = a->header;
+    down(a->semid);
+    if (atomic_load(&h->generation) == full + 1) {
+        if (full + 1 == MAX_EXTENTS) {
+            fprintf(stderr, "arena exhausted\n");
+            exit(1);
+        }
+        size_t size = h->sizes[full] * 2;
+        while (size < need)
+            size *= 2;
+        if (size > MAX_EXTENT_SIZE)
+            size = MAX_EXTENT_SIZE; // need <= MAX_EXTENT_SIZE: arena_alloc checked
+        h->shmids[full + 1] = create_extent(size);
+        h->sizes[full + 1] = size;
+        // Publish the extent before moving allocation into it
+        atomic_store_explicit(&h->generation, full + 2, memory_order_release);
+        atomic_store_explicit(&h->top, (arena_ref)(full + 1) << 32, memory_order_release);
+    }
+    up(a->semid);
+}
+
+// Function to allocate `size` bytes; bump allocation with a CAS, growing when full.
+// Returns NULL_REF if `size` is more than one extent can hold.
+arena_ref arena_alloc(struct arena *a, size_t size) {
+    struct arena_header *h = a->header;
+    if (size > (MAX_EXTENT_SIZE & ~(size_t)15))
+        return NULL_REF;
+    size = (size + 15) & ~(size_t)15;
+    for (;;) {
+        arena_ref top = atomic_load_explicit(&h->top, memory_order_acquire);
+        uint32_t extent = (uint32_t)(top >> 32);
+        uint32_t offset = (uint32_t)top;
+        if (offset + size <= h->sizes[extent]) {
+            if (atomic_compare_exchange_weak(&h->top, &top, top + size))
+                return top;
+        } else {
+            arena_grow(a, extent, size);
+        }
+    }
+}
+
+int main() {
+    struct arena a;
+    arena_create(&a);
+    int writers = 4, per_writer = 500; // ~48 KiB of records: far more than the first extent
+
+    for (int w = 0; w < writers; w++) {
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid == -1) {
+            perror("fork failed");
+            exit(1);
+        }
+        if (pid == 0) { // Child: Writer
+            for (int i = 0; i < per_writer; i++) {
+                arena_ref ref = arena_alloc(&a, sizeof(struct record));
+                struct record *r = arena_ptr(&a, ref);
+                r->writer = getpid();
+                snprintf(r->text, sizeof(r->text), "record %d from writer %d", i, w);
+                // Push onto the shared list so the parent can find it
+                r->next = atomic_load(&a.header->list_head);
+                while (!atomic_compare_exchange_weak(&a.header->list_head, &r->next, ref))
+                    ;
+            }
+            printf("Writer %d done, attached %u extents\n", w, a.attached);
+            exit(0);
+        }
+    }
+
+    // Parent: Reader
+    for (int w = 0; w < writers; w++) {
+        if (wait(NULL) == -1) {
+            perror("wait failed");
+            exit(1);
+        }
+    }
+    int count = 0;
+    struct record *first = NULL;
+    for (arena_ref ref = atomic_load(&a.header->list_head); ref != NULL_REF; ref = ((struct record *)arena_ptr(&a, ref))->next) {
+        if (first == NULL)
+            first = arena_ptr(&a, ref);
+        count++;
+    }
+    printf("Parent read %d records (newest: \"%s\")\n", count, first ? first->text : "");
+    printf("Allocating 8 GiB: %s\n", arena_alloc(&a, 8UL << 30) == NULL_REF ? "refused" : "allocated");
+    arena_sync(&a); // Also attach extents no reference led us to, so they are removed too
+    for (uint32_t e = 0; e < a.attached; e++)
+        printf("  extent %u: %zu bytes\n", e, a.header->sizes[e]);
+
+    // Remove every extent, the header and the semaphore (cleanup)
+    for (uint32_t e = 0; e < a.attached; e++) {
+        if (shmdt(a.base[e]) == -1 || shmctl(a.header->shmids[e], IPC_RMID, NULL) == -1) {
+            perror("Cleaning up (shmctl) failed");
+            exit(1);
+        }
+    }
+    if (shmdt(a.header) == -1 || shmctl(a.header_id, IPC_RMID, NULL) == -1) {
+        perror("Cleaning up (shmctl) failed");
+        exit(1);
+    }
+    if (semctl(a.semid, 0, IPC_RMID) == -1) {
+        perror("Cleaning up (semctl) failed");
+        exit(1);
+    }
+    return 0;
+}
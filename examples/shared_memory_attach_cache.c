@@ -0,0 +1,269 @@
+#include <sys/types.h> // For pid_t
+#include <sys/ipc.h>   // For IPC_PRIVATE, etc.
+#include <sys/shm.h>   // For shared memory functions
+#include <sys/sem.h>   // For semaphore functions
+#include <sys/wait.h>  // For waitpid
+#include <stdio.h>     // For printf, perror, snprintf
+#include <stdlib.h>    // For exit
+#include <time.h>      // For clock_gettime
+#include <unistd.h>    // For fork, usleep
+
+// A per-process cache of shared memory attachments.
+//
+// shared_memory.c attaches, uses the segment once and detaches. A service that does that
+// on every request pays for a new mapping each time, and for tearing it down again
+// (unmapping flushes TLB entries on every CPU running the process). shm_cache_get()
+// instead keeps the mapping after shm_cache_put() and hands it out again next time.
+// Idle mappings are detached lazily:
+//
+// - when the idle mapped bytes exceed a budget, least recently used first, and
+// - when IPC_STAT shows the segment was removed (IPC_RMID marks it SHM_DEST; it only
+//   really goes away once everyone has detached, so the cache must let go of it).
+//
+// The cache is per process and not thread-safe, like the rest of these examples.
+
+#define CACHE_ENTRIES 64
+#define STAT_EVERY 1024 // Puts between checks for removed segments
+
+struct attachment {
+    int shmid;          // -1 when the entry is free
+    void *addr;
+    size_t size;
+    int refs;
+    unsigned long last_used;
+};
+
+struct attachment cache[CACHE_ENTRIES];
+size_t idle_bytes, budget = 64 << 20;
+unsigned long tick, hits, misses, evictions, removals;
+
+void shm_cache_init(size_t idle_budget) {
+    for (int i = 0; i < CACHE_ENTRIES; i++)
+        cache[i].shmid = -1;
+    budget = idle_budget;
+}
+
+void evict(struct attachment *a) {
+    if (shmdt(a->addr) == -1) {
+        perror("shmdt failed");
+        exit(1);
+    }
+    idle_bytes -= a->size;
+    a->shmid = -1;
+}
+
+// Function to detach idle entries whose segment was removed, then trim to the budget
+void shm_cache_trim(void) {
+    for (int i = 0; i < CACHE_ENTRIES; i++) {
+        struct attachment *a = &cache[i];
+        if (a->shmid == -1 || a->refs > 0)
+            continue;
+        struct shmid_ds ds;
+        if (shmctl(a->shmid, IPC_STAT, &ds) == -1 || (ds.shm_perm.mode & SHM_DEST)) {
+            evict(a);
+            removals++;
+        }
+    }
+    while (idle_bytes > budget) {
+        struct attachment *lru = NULL;
+        for (int i = 0; i < CACHE_ENTRIES; i++)
+            if (cache[i].shmid != -1 && cache[i].refs == 0 && (!lru || cache[i].last_used < lru->last_used))
+                lru = &cache[i];
+        evict(lru);
+        evictions++;
+    }
+}
+
+struct attachment *free_entry(void) {
+    for (int i = 0; i < CACHE_ENTRIES; i++)
+        if (cache[i].shmid == -1)
+            return &cache[i];
+    return NULL;
+}
+
+// Function to get a read/write mapping of a segment, attaching only on a cache miss.
+// Returns NULL if every entry is in use (the caller can shmat() without the cache).
+void *shm_cache_get(int shmid) {
+    for (int i = 0; i < CACHE_ENTRIES; i++) {
+        struct attachment *a = &cache[i];
+        if (a->shmid == shmid) {
+            if (a->refs++ == 0)
+                idle_bytes -= a->size;
+            hits++;
+            return a->addr;
+        }
+    }
+    misses++;
+    struct attachment *entry = free_entry();
+    if (!entry) { // Table full: drop every idle mapping and look once more
+        size_t saved = budget;
+        budget = 0;
+        shm_cache_trim();
+        budget = saved;
+        entry = free_entry();
+        if (!entry)
+            return NULL; // Every entry is held
+    }
+    struct shmid_ds ds;
+    if (shmctl(shmid, IPC_STAT, &ds) == -1) {
+        perror("shmctl(IPC_STAT) failed");
+        exit(1);
+    }
+    void *addr = shmat(shmid, NULL, 0);
+    if (addr == (void *)-1) {
+        perror("shmat failed");
+        exit(1);
+    }
+    *entry = (struct attachment){shmid, addr, ds.shm_segsz, 1, tick};
+    return addr;
+}
+
+// Function to release a mapping obtained from shm_cache_get (it stays attached)
+void shm_cache_put(void *addr) {
+    for (int i = 0; i < CACHE_ENTRIES; i++) {
+        struct attachment *a = &cache[i];
+        if (a->shmid != -1 && a->addr == addr) {
+            a->last_used = ++tick;
+            if (--a->refs == 0)
+                idle_bytes += a->size;
+            break;
+        }
+    }
+    if (idle_bytes > budget || tick % STAT_EVERY == 0)
+        shm_cache_trim();
+}
+
+union semun { int val; }; // Union for semctl arguments
+
+// Function to perform a semaphore "down" (decrement) operation
+void down(int semid) {
+    struct sembuf op = {0, -1, 0};
+    if (semop(semid, &op, 1) == -1) {
+        perror("down failed");
+        exit(1);
+    }
+}
+
+// Function to perform a semaphore "up" (increment) operation
+void up(int semid) {
+    struct sembuf op = {0, 1, 0};
+    if (semop(semid, &op, 1) == -1) {
+        perror("up failed");
+        exit(1);
+    }
+}
+
+double now_usec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+int main() {
+    enum { SEGMENTS = 8, SIZE = 4 << 20, REQUESTS = 100000 };
+    int shmids[SEGMENTS];
+    for (int s = 0; s < SEGMENTS; s++) {
+        shmids[s] = shmget(IPC_PRIVATE, SIZE, IPC_CREAT | 0666);
+        if (shmids[s] == -1) {
+            perror("shmget failed");
+            exit(1);
+        }
+        char *shmaddr = shmat(shmids[s], NULL, 0);
+        if (shmaddr == (void *)-1) {
+            perror("shmat failed");
+            exit(1);
+        }
+        snprintf(shmaddr, SIZE, "Hello from segment %d!", s);
+        if (shmdt(shmaddr) == -1) {
+            perror("shmdt failed");
+            exit(1);
+        }
+    }
+
+    int semid = semget(IPC_PRIVATE, 1, IPC_CREAT | 0666); // Child signals when segment 4 is cached
+    if (semid == -1) {
+        perror("semget failed");
+        exit(1);
+    }
+    union semun arg = {0};
+    if (semctl(semid, 0, SETVAL, arg) == -1) {
+        perror("semctl failed");
+        exit(1);
+    }
+
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == -1) {
+        perror("fork failed");
+        exit(1);
+    }
+    if (pid == 0) { // Child: a service that touches a segment on every request
+        long checksum = 0;
+        double t0 = now_usec();
+        for (int r = 0; r < REQUESTS; r++) {
+            char *shmaddr = shmat(shmids[r % SEGMENTS], NULL, 0);
+            if (shmaddr == (void *)-1) {
+                perror("shmat failed");
+                exit(1);
+            }
+            checksum += shmaddr[19];
+            if (shmdt(shmaddr) == -1) {
+                perror("shmdt failed");
+                exit(1);
+            }
+        }
+        double t1 = now_usec();
+        shm_cache_init(4 * (size_t)SIZE); // Room for half of the segments when idle
+        for (int r = 0; r < REQUESTS; r++) {
+            char *shmaddr = shm_cache_get(shmids[r % 4]); // Hot set: fits the budget
+            checksum += shmaddr[19];
+            shm_cache_put(shmaddr);
+        }
+        double t2 = now_usec();
+        printf("Per request: shmat/shmdt %.2f us, cached %.3f us (hits %lu, misses %lu)\n",
+               (t1 - t0) / REQUESTS, (t2 - t1) / REQUESTS, hits, misses);
+
+        for (int s = 0; s < SEGMENTS; s++) { // Touch all eight: the budget forces LRU evictions
+            char *shmaddr = shm_cache_get(shmids[s]);
+            checksum += shmaddr[19];
+            shm_cache_put(shmaddr);
+        }
+        printf("After touching all %d segments: %lu evicted for the %zu MiB idle budget\n",
+               SEGMENTS, evictions, budget >> 20);
+
+        // The parent removes segment 4 (cached, idle) while we keep serving requests
+        fflush(stdout);
+        up(semid);
+        for (double end = now_usec() + 2e6; removals == 0 && now_usec() < end;) {
+            char *shmaddr = shm_cache_get(shmids[5 + tick % 3]);
+            checksum += shmaddr[19];
+            shm_cache_put(shmaddr);
+            usleep(10);
+        }
+        printf("Removed segment noticed and detached: %s (checksum %ld)\n", removals ? "yes" : "no", checksum);
+        exit(removals == 0);
+    }
+
+    // Parent: remove one segment while the child still has it cached
+    down(semid);
+    if (shmctl(shmids[4], IPC_RMID, NULL) == -1) {
+        perror("Cleaning up (shmctl) failed");
+        exit(1);
+    }
+    int status;
+    if (waitpid(pid, &status, 0) == -1) {
+        perror("waitpid failed");
+        exit(1);
+    }
+    if (semctl(semid, 0, IPC_RMID) == -1) {
+        perror("Cleaning up (semctl) failed");
+        exit(1);
+    }
+    for (int s = 0; s < SEGMENTS; s++) {
+        if (s != 4 && shmctl(shmids[s], IPC_RMID, NULL) == -1) {
+            perror("Cleaning up (shmctl) failed");
+            exit(1);
+        }
+    }
+    return !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+}
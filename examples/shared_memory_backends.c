@@ -0,0 +1,301 @@
+#define _GNU_SOURCE            // For memfd_create, MAP_POPULATE, F_ADD_SEALS
+#include <sys/types.h>         // For pid_t
+#include <sys/ipc.h>           // For IPC_PRIVATE, etc.
+#include <sys/shm.h>           // For shmget, shmat, shmdt, shmctl
+#include <sys/mman.h>          // For shm_open, mmap, munmap, memfd_create
+#include <sys/stat.h>          // For mode constants
+#include <sys/socket.h>        // For socketpair, sendmsg, recvmsg
+#include <sys/resource.h>      // For getrusage
+#include <sys/wait.h>          // For waitpid
+#include <fcntl.h>             // For O_CREAT, F_ADD_SEALS
+#include <stdio.h>             // For printf, perror, snprintf
+#include <string.h>            // For strcmp, strcpy, memset
+#include <stdlib.h>            // For exit, strtoul
+#include <time.h>              // For clock_gettime
+#include <unistd.h>            // For fork, ftruncate, close
+
+// The same segment API on three kernel mechanisms, picked at runtime:
+//
+// - sysv:  shmget/shmat, as in shared_memory.c. Counts against the system-wide SHMMNI/SHMALL limits.
+// - posix: shm_open + mmap. Named like a file under /dev/shm; no SysV limits.
+// - memfd: memfd_create + mmap. Anonymous: the only way in is the file descriptor, which is
+//          passed to other processes over a Unix socket. Can be sealed so receivers know the
+//          size will never change under them.
+//
+// All three attach with SEG_POPULATE to fault every page in up front (MAP_POPULATE for
+// mmap, a populate hint or touching pass for shmat), and sysv/memfd can use huge pages.
+// Every backend treats SEG_HUGE the same way: if it can't get huge pages (none reserved,
+// or no hugetlbfs mount for posix), it says so and falls back to normal pages.
+
+#define SEG_RDONLY   1
+#define SEG_POPULATE 2
+#define SEG_HUGE     4
+
+struct segment {
+    const struct backend *ops;
+    int id;         // shmid (sysv) or file descriptor (posix, memfd)
+    size_t size;
+    char name[64];  // shm_open name (posix)
+};
+
+struct backend {
+    const char *name;
+    int passes_fd;  // The id is a file descriptor that must travel with SCM_RIGHTS
+    void (*create)(struct segment *seg, size_t size, int flags);
+    void *(*attach)(struct segment *seg, int flags);
+    void (*detach)(struct segment *seg, void *addr);
+    void (*destroy)(struct segment *seg);
+};
+
+void die(const char *what) {
+    perror(what);
+    exit(1);
+}
+
+// Function to fault in every page of a mapping, for mechanisms without MAP_POPULATE
+void populate(void *addr, size_t size, int flags) {
+#ifdef MADV_POPULATE_WRITE
+    if (madvise(addr, size, (flags & SEG_RDONLY) ? MADV_POPULATE_READ : MADV_POPULATE_WRITE) == 0)
+        return;
+#endif
+    volatile char *p = addr; // Older kernels: touch one byte per page
+    for (size_t off = 0; off < size; off += 4096) {
+        if (flags & SEG_RDONLY)
+            (void)p[off];
+        else // Adding 0 atomically write-faults the page without losing a concurrent write
+            __atomic_fetch_add((char *)addr + off, 0, __ATOMIC_RELAXED);
+    }
+}
+
+// System V backend
+void sysv_create(struct segment *seg, size_t size, int flags) {
+    seg->size = size;
+    seg->id = -1;
+    if (flags & SEG_HUGE) {
+        seg->id = shmget(IPC_PRIVATE, size, IPC_CREAT | SHM_HUGETLB | 0666);
+        if (seg->id == -1)
+            perror("sysv: shmget(SHM_HUGETLB) failed, using normal pages");
+    }
+    if (seg->id == -1)
+        seg->id = shmget(IPC_PRIVATE, size, IPC_CREAT | 0666);
+    if (seg->id == -1)
+        die("shmget failed");
+}
+
+void *sysv_attach(struct segment *seg, int flags) {
+    void *addr = shmat(seg->id, NULL, (flags & SEG_RDONLY) ? SHM_RDONLY : 0);
+    if (addr == (void *)-1)
+        die("shmat failed");
+    if (flags & SEG_POPULATE)
+        populate(addr, seg->size, flags);
+    return addr;
+}
+
+void sysv_detach(struct segment *seg, void *addr) {
+    (void)seg;
+    if (shmdt(addr) == -1)
+        die("shmdt failed");
+}
+
+void sysv_destroy(struct segment *seg) {
+    if (shmctl(seg->id, IPC_RMID, NULL) == -1)
+        die("Cleaning up (shmctl) failed");
+}
+
+// Shared by the two file-descriptor backends
+void *fd_attach(struct segment *seg, int flags) {
+    int prot = (flags & SEG_RDONLY) ? PROT_READ : PROT_READ | PROT_WRITE;
+    void *addr = mmap(NULL, seg->size, prot, MAP_SHARED | ((flags & SEG_POPULATE) ? MAP_POPULATE : 0), seg->id, 0);
+    if (addr == MAP_FAILED)
+        die("mmap failed");
+    return addr;
+}
+
+void fd_detach(struct segment *seg, void *addr) {
+    if (munmap(addr, seg->size) == -1)
+        die("munmap failed");
+}
+
+// POSIX backend
+void posix_create(struct segment *seg, size_t size, int flags) {
+    if (flags & SEG_HUGE)
+        fprintf(stderr, "posix: huge pages need a hugetlbfs mount, using normal pages\n");
+    seg->size = size;
+    snprintf(seg->name, sizeof(seg->name), "/ipc-guide-%d", (int)getpid());
+    seg->id = shm_open(seg->name, O_CREAT | O_EXCL | O_RDWR, 0666);
+    if (seg->id == -1)
+        die("shm_open failed");
+    if (ftruncate(seg->id, size) == -1)
+        die("ftruncate failed");
+}
+
+void posix_destroy(struct segment *seg) {
+    close(seg->id);
+    if (shm_unlink(seg->name) == -1)
+        die("Cleaning up (shm_unlink) failed");
+}
+
+// memfd backend
+// Function to create a hugetlb memfd; returns -1 if the huge pages can't be reserved.
+// They are only reserved by mmap, so map it once here instead of failing in every receiver.
+int memfd_huge(size_t size) {
+    int fd = memfd_create("ipc-guide", MFD_CLOEXEC | MFD_HUGETLB);
+    if (fd == -1)
+        return -1;
+    void *addr = MAP_FAILED;
+    if (ftruncate(fd, size) == 0)
+        addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) {
+        close(fd);
+        return -1;
+    }
+    munmap(addr, size); // The reservation stays with the file
+    return fd;
+}
+
+void memfd_backend_create(struct segment *seg, size_t size, int flags) {
+    seg->size = size;
+    seg->id = -1;
+    if (flags & SEG_HUGE) {
+        seg->id = memfd_huge(size);
+        if (seg->id != -1)
+            return; // hugetlb files can't be sealed
+        perror("memfd: huge pages unavailable, using normal pages");
+    }
+    seg->id = memfd_create("ipc-guide", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (seg->id == -1)
+        die("memfd_create failed");
+    if (ftruncate(seg->id, size) == -1)
+        die("ftruncate failed");
+    // Freeze the size: a receiver can map it without fearing SIGBUS from a later shrink
+    if (fcntl(seg->id, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) == -1)
+        die("fcntl(F_ADD_SEALS) failed");
+}
+
+void memfd_destroy(struct segment *seg) {
+    close(seg->id); // Memory is freed when the last descriptor and mapping are gone
+}
+
+const struct backend backends[] = {
+    {"sysv",  0, sysv_create,          sysv_attach, sysv_detach, sysv_destroy},
+    {"posix", 0, posix_create,         fd_attach,   fd_detach,   posix_destroy},
+    {"memfd", 1, memfd_backend_create, fd_attach,   fd_detach,   memfd_destroy},
+};
+#define NUM_BACKENDS (int)(sizeof(backends) / sizeof(backends[0]))
+
+// Function to hand a segment to another process. The description travels as plain bytes;
+// for memfd the descriptor itself rides along as SCM_RIGHTS ancillary data.
+void send_segment(int sock, const struct segment *seg) {
+    char control[CMSG_SPACE(sizeof(int))];
+    struct iovec iov = {(void *)seg, sizeof(*seg)};
+    struct msghdr msg = {0};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    if (seg->ops->passes_fd) {
+        memset(control, 0, sizeof(control));
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+        memcpy(CMSG_DATA(cmsg), &seg->id, sizeof(int));
+    }
+    if (sendmsg(sock, &msg, 0) == -1)
+        die("sendmsg failed");
+}
+
+void recv_segment(int sock, struct segment *seg) {
+    char control[CMSG_SPACE(sizeof(int))];
+    struct iovec iov = {seg, sizeof(*seg)};
+    struct msghdr msg = {0};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    if (recvmsg(sock, &msg, 0) != sizeof(*seg))
+        die("recvmsg failed");
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    if (cmsg && cmsg->cmsg_type == SCM_RIGHTS)
+        memcpy(&seg->id, CMSG_DATA(cmsg), sizeof(int)); // Our own number for the same memfd
+}
+
+double now_usec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+long minor_faults(void) {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_minflt;
+}
+
+// Function to measure attach cost and page faults in a fresh child process; returns the
+// number of children that failed
+int bench(const struct backend *ops, size_t size, int extra) {
+    int failed = 0;
+    struct segment seg = {ops, -1, 0, ""};
+    ops->create(&seg, size, extra);
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == -1)
+        die("socketpair failed");
+
+    for (int populate_flag = 0; populate_flag <= SEG_POPULATE; populate_flag += SEG_POPULATE) {
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid == -1)
+            die("fork failed");
+        if (pid == 0) { // Child: receives the segment, attaches and writes every page
+            struct segment mine;
+            close(sv[0]);
+            if (ops->passes_fd)
+                close(seg.id); // Prove the descriptor really arrives over the socket
+            recv_segment(sv[1], &mine);
+            mine.ops = ops;
+            long f0 = minor_faults();
+            double t0 = now_usec();
+            char *addr = ops->attach(&mine, populate_flag);
+            double t1 = now_usec();
+            long f1 = minor_faults();
+            memset(addr, 1, mine.size);
+            double t2 = now_usec();
+            long f2 = minor_faults();
+            ops->detach(&mine, addr);
+            double t3 = now_usec();
+            printf("%-6s %-9s attach %9.1f us (%6ld faults)  first write %9.1f us (%6ld faults)  detach %7.1f us\n",
+                   ops->name, populate_flag ? "populate" : "lazy", t1 - t0, f1 - f0, t2 - t1, f2 - f1, t3 - t2);
+            exit(0);
+        }
+        send_segment(sv[0], &seg); // Parent: hand over the segment
+        int status;
+        if (waitpid(pid, &status, 0) == -1)
+            die("waitpid failed");
+        failed += !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+    }
+    close(sv[0]);
+    close(sv[1]);
+    ops->destroy(&seg);
+    return failed;
+}
+
+// Usage: shared_memory_backends [sysv|posix|memfd|all] [size_mib] [huge]
+int main(int argc, char *argv[]) {
+    const char *which = argc > 1 ? argv[1] : "all";
+    size_t size = (argc > 2 ? strtoul(argv[2], NULL, 10) : 64) << 20;
+    int extra = (argc > 3 && strcmp(argv[3], "huge") == 0) ? SEG_HUGE : 0;
+
+    int found = 0, failed = 0;
+    for (int b = 0; b < NUM_BACKENDS; b++) {
+        if (strcmp(which, "all") == 0 || strcmp(which, backends[b].name) == 0) {
+            failed += bench(&backends[b], size, extra);
+            found = 1;
+        }
+    }
+    if (!found) {
+        fprintf(stderr, "unknown backend '%s' (use sysv, posix, memfd or all)\n", which);
+        exit(1);
+    }
+    return failed != 0;
+}
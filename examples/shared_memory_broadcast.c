@@ -0,0 +1,187 @@
+#include <sys/types.h> // For pid_t
+#include <sys/ipc.h>   // For IPC_PRIVATE, etc.
+#include <sys/shm.h>   // For shared memory functions
+#include <sys/wait.h>  // For wait
+#include <stdatomic.h> // For atomic_* operations
+#include <stdint.h>    // For uint64_t, int64_t
+#include <stdio.h>     // For printf, perror
+#include <stdlib.h>    // For exit, atoi
+#include <time.h>      // For clock_gettime
+#include <unistd.h>    // For fork, usleep
+#include <sched.h>     // For sched_yield
+
+// One writer, many readers, every reader sees every entry (a "disruptor"-style ring).
+//
+// The writer fills slot (seq % SLOTS) and then advances a published cursor. Each reader
+// keeps its own cursor in the segment and processes entries in place, straight out of the
+// ring: nothing is copied and a reader never touches another reader's state, so adding
+// readers costs the writer nothing but one more cursor to look at.
+//
+// - GATED:     the writer never laps the slowest reader. It remembers the minimum reader
+//              cursor it saw last and rescans the cursors only when it catches up with it.
+// - OVERWRITE: the writer never waits. Each slot records which sequence it holds, so a
+//              reader that fell a whole ring behind notices, counts the loss and skips ahead.
+
+#define SLOTS 4096 // Must be a power of two
+#define MAX_READERS 64
+
+enum mode { GATED, OVERWRITE };
+
+struct entry {
+    _Atomic int64_t seq;  // Sequence number stored in this slot (-1 before first use)
+    double price;
+    int64_t quantity;
+    int64_t check;        // seq * 3 + quantity, to spot entries changed under the reader
+};
+
+struct cursor { _Alignas(64) _Atomic int64_t value; };
+
+struct broadcast_ring {
+    _Alignas(64) _Atomic int64_t published;   // Highest sequence readers may consume
+    _Alignas(64) int mode;
+    int readers;
+    struct cursor cursors[MAX_READERS];       // Next sequence each reader wants
+    struct entry slots[SLOTS];
+};
+
+void spin(int *spins) {
+    if (++*spins > 1000)
+        sched_yield(); // Fewer CPUs than processes: let the other side run
+}
+
+// Function to publish the entry with sequence `seq` (writer only; seq counts up from 0)
+void ring_publish(struct broadcast_ring *r, int64_t seq, double price, int64_t quantity, int64_t *gate) {
+    if (r->mode == GATED) {
+        // Only look at the readers when we might be about to overwrite an unread slot
+        for (int spins = 0; seq - *gate >= SLOTS; spin(&spins)) {
+            int64_t min = INT64_MAX;
+            for (int i = 0; i < r->readers; i++) {
+                int64_t c = atomic_load_explicit(&r->cursors[i].value, memory_order_acquire);
+                if (c < min)
+                    min = c;
+            }
+            *gate = min;
+        }
+    }
+    struct entry *e = &r->slots[seq & (SLOTS - 1)];
+    atomic_store_explicit(&e->seq, -1, memory_order_relaxed); // Slot is in flux
+    atomic_thread_fence(memory_order_release);
+    e->price = price;
+    e->quantity = quantity;
+    e->check = seq * 3 + quantity;
+    atomic_store_explicit(&e->seq, seq, memory_order_release);
+    atomic_store_explicit(&r->published, seq, memory_order_release);
+}
+
+void reader(struct broadcast_ring *r, int id, int64_t total, int slow) {
+    int64_t next = 0, seen = 0, lost = 0, bad = 0;
+    double sum = 0;
+    while (next < total) {
+        int spins = 0;
+        int64_t available;
+        while ((available = atomic_load_explicit(&r->published, memory_order_acquire)) < next)
+            spin(&spins);
+        for (; next <= available; next++) { // Consume the whole batch, then publish our cursor once
+            struct entry *e = &r->slots[next & (SLOTS - 1)];
+            if (r->mode == OVERWRITE && available - next >= SLOTS) {
+                int64_t resume = available - SLOTS + 1; // Fell a lap behind: skip to the oldest live slot
+                lost += resume - next;
+                next = resume;
+                e = &r->slots[next & (SLOTS - 1)];
+            }
+            double price = e->price; // Process in place
+            int64_t quantity = e->quantity, check = e->check;
+            atomic_thread_fence(memory_order_acquire);
+            if (atomic_load_explicit(&e->seq, memory_order_relaxed) != next) {
+                lost++; // Overwritten while we looked at it (OVERWRITE mode only)
+                continue;
+            }
+            bad += check != next * 3 + quantity;
+            sum += price * quantity;
+            seen++;
+        }
+        atomic_store_explicit(&r->cursors[id].value, next, memory_order_release);
+        if (slow)
+            usleep(1000); // A laggard, to show gating / loss detection
+    }
+    printf("Reader %d%s: %lld entries, %lld lost, %lld inconsistent (notional %.0f)\n", id, slow ? " (slow)" : "",
+           (long long)seen, (long long)lost, (long long)bad, sum);
+    exit(bad != 0 || (r->mode == GATED && lost != 0));
+}
+
+double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int run(enum mode mode, int readers, int64_t total) {
+    int shmid = shmget(IPC_PRIVATE, sizeof(struct broadcast_ring), IPC_CREAT | 0666);
+    if (shmid == -1) {
+        perror("shmget failed");
+        exit(1);
+    }
+    struct broadcast_ring *r = shmat(shmid, NULL, 0); // Attached before fork: children inherit it
+    if (r == (void *)-1) {
+        perror("shmat failed");
+        exit(1);
+    }
+    atomic_store(&r->published, -1);
+    r->mode = mode;
+    r->readers = readers;
+    for (int i = 0; i < SLOTS; i++)
+        atomic_store(&r->slots[i].seq, -1);
+
+    printf("%s mode, %d readers:\n", mode == GATED ? "Gated" : "Overwrite", readers);
+    for (int i = 0; i < readers; i++) {
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid == -1) {
+            perror("fork failed");
+            exit(1);
+        }
+        if (pid == 0) // Child: Reader (the last one is slow)
+            reader(r, i, total, i == readers - 1);
+    }
+
+    // Parent: Writer
+    double start = now_sec();
+    int64_t gate = 0;
+    for (int64_t seq = 0; seq < total; seq++) {
+        ring_publish(r, seq, 100.0 + (seq % 50) * 0.01, 1 + seq % 10, &gate);
+        if (seq % 1024 == 1023)
+            usleep(100); // Updates arrive in bursts
+    }
+    printf("Writer: %lld entries in %.3f s\n", (long long)total, now_sec() - start);
+
+    int failed = 0;
+    for (int i = 0; i < readers; i++) {
+        int status;
+        if (wait(&status) == -1) {
+            perror("wait failed");
+            exit(1);
+        }
+        failed |= !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+    }
+    if (shmdt(r) == -1) {
+        perror("shmdt failed");
+        exit(1);
+    }
+    if (shmctl(shmid, IPC_RMID, NULL) == -1) {
+        perror("Cleaning up (shmctl) failed");
+        exit(1);
+    }
+    return failed;
+}
+
+// Usage: shared_memory_broadcast [readers]
+int main(int argc, char *argv[]) {
+    int readers = argc > 1 ? atoi(argv[1]) : 4;
+    if (readers < 1 || readers > MAX_READERS) {
+        fprintf(stderr, "readers must be between 1 and %d\n", MAX_READERS);
+        exit(1);
+    }
+    int failed = run(GATED, readers, 1000000);
+    failed |= run(OVERWRITE, readers, 1000000);
+    return failed;
+}
@@ -0,0 +1,254 @@
+#include <sys/types.h> // For pid_t
+#include <sys/ipc.h>   // For IPC_PRIVATE, etc.
+#include <sys/shm.h>   // For shared memory functions
+#include <sys/sem.h>   // For semaphore functions
+#include <sys/mman.h>  // For mmap, munmap
+#include <sys/stat.h>  // For fstat
+#include <sys/wait.h>  // For waitpid
+#include <fcntl.h>     // For open
+#include <stdint.h>    // For uint64_t
+#include <stdio.h>     // For printf, perror, snprintf, rename
+#include <string.h>    // For memcpy, memcmp
+#include <stdlib.h>    // For exit, realloc
+#include <time.h>      // For clock_gettime
+#include <unistd.h>    // For fork, write, fsync, usleep
+
+// Checkpointing a segment to disk and restoring it at startup (a warm restart).
+//
+// fork() alone can't snapshot shared memory: copy-on-write applies to private pages, and a
+// child keeps seeing every later write to a shared segment. So the checkpoint works in two
+// steps. First it takes the segment's semaphore and copies the segment into private memory
+// (writers wait only for a memcpy). Then it forks: the child owns a frozen copy of that
+// private buffer and does the slow part (write, fsync, rename) while writers carry on.
+// The file is written next to its final name and renamed, so a crash mid-checkpoint leaves
+// the previous snapshot intact.
+
+#define SNAPSHOT "shared_memory.snapshot"
+#define MAGIC 0x31504e5343504955ULL // "UIPCSNP1"
+#define SLOTS (1 << 20)
+
+struct snapshot_header {
+    uint64_t magic;
+    uint64_t size;     // Bytes of segment data that follow
+    uint64_t checksum; // Of the data, to reject torn or truncated files
+};
+
+// The shared data: a cache-like table of counters. Consistent when total == sum of slots.
+struct cache {
+    uint64_t total;
+    uint64_t slots[SLOTS];
+};
+
+union semun { int val; }; // Union for semctl arguments
+
+// Function to perform a semaphore "down" (decrement) operation
+void down(int semid) {
+    struct sembuf op = {0, -1, SEM_UNDO}; // Released automatically if we crash holding it
+    if (semop(semid, &op, 1) == -1) {
+        perror("down failed");
+        exit(1);
+    }
+}
+
+// Function to perform a semaphore "up" (increment) operation
+void up(int semid) {
+    struct sembuf op = {0, 1, SEM_UNDO};
+    if (semop(semid, &op, 1) == -1) {
+        perror("up failed");
+        exit(1);
+    }
+}
+
+uint64_t checksum(const void *data, size_t size) {
+    const uint64_t *p = data;
+    uint64_t h = 1469598103934665603ULL;
+    for (size_t i = 0; i < size / 8; i++)
+        h = (h ^ p[i]) * 1099511628211ULL;
+    return h;
+}
+
+double now_usec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+// Function to checkpoint a segment; returns the child writing the file.
+// *paused is set to how long writers were held up.
+pid_t checkpoint(const void *shmaddr, size_t size, int semid, double *paused) {
+    static void *copy; // Reused between checkpoints, grown when a segment is larger
+    static size_t copy_size;
+    if (size > copy_size) {
+        void *bigger = realloc(copy, size);
+        if (!bigger) {
+            perror("realloc failed");
+            exit(1);
+        }
+        copy = bigger;
+        copy_size = size;
+    }
+    double start = now_usec();
+    down(semid);
+    memcpy(copy, shmaddr, size); // The only moment writers are stopped
+    up(semid);
+    *paused = now_usec() - start;
+
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == -1) {
+        perror("fork failed");
+        exit(1);
+    }
+    if (pid != 0)
+        return pid;
+
+    // Child: Snapshot writer
+    struct snapshot_header h = {MAGIC, size, checksum(copy, size)};
+    int fd = open(SNAPSHOT ".tmp", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1) {
+        perror("open snapshot failed");
+        exit(1);
+    }
+    if (write(fd, &h, sizeof(h)) != sizeof(h) || write(fd, copy, size) != (ssize_t)size) {
+        perror("write snapshot failed");
+        exit(1);
+    }
+    if (fsync(fd) == -1 || close(fd) == -1 || rename(SNAPSHOT ".tmp", SNAPSHOT) == -1) {
+        perror("saving snapshot failed");
+        exit(1);
+    }
+    exit(0);
+}
+
+// Function to fill a freshly attached segment from the snapshot file; returns 1 on success
+int restore(void *shmaddr, size_t size) {
+    int fd = open(SNAPSHOT, O_RDONLY);
+    if (fd == -1)
+        return 0; // No snapshot: cold start
+    struct stat st;
+    if (fstat(fd, &st) == -1 || (size_t)st.st_size != sizeof(struct snapshot_header) + size) {
+        close(fd);
+        return 0;
+    }
+    char *file = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0); // Map the file back
+    close(fd);
+    if (file == MAP_FAILED) {
+        perror("mmap snapshot failed");
+        exit(1);
+    }
+    const struct snapshot_header *h = (const void *)file;
+    int ok = h->magic == MAGIC && h->size == size && checksum(file + sizeof(*h), size) == h->checksum;
+    if (ok)
+        memcpy(shmaddr, file + sizeof(*h), size);
+    munmap(file, st.st_size);
+    return ok;
+}
+
+int consistent(const struct cache *c) {
+    uint64_t sum = 0;
+    for (int i = 0; i < SLOTS; i++)
+        sum += c->slots[i];
+    return sum == c->total;
+}
+
+int main() {
+    int shmid = shmget(IPC_PRIVATE, sizeof(struct cache), IPC_CREAT | 0666);
+    if (shmid == -1) {
+        perror("shmget failed");
+        exit(1);
+    }
+    struct cache *c = shmat(shmid, NULL, 0); // Attached before fork: children inherit it
+    if (c == (void *)-1) {
+        perror("shmat failed");
+        exit(1);
+    }
+    int semid = semget(IPC_PRIVATE, 1, IPC_CREAT | 0666);
+    if (semid == -1) {
+        perror("semget failed");
+        exit(1);
+    }
+    union semun arg = {1}; // Unlocked
+    if (semctl(semid, 0, SETVAL, arg) == -1) {
+        perror("semctl failed");
+        exit(1);
+    }
+
+    double start = now_usec();
+    if (restore(c, sizeof(*c)))
+        printf("Warm start: restored %llu updates in %.1f ms (consistent: %s)\n",
+               (unsigned long long)c->total, (now_usec() - start) / 1e3, consistent(c) ? "yes" : "NO");
+    else
+        printf("Cold start: no usable %s\n", SNAPSHOT);
+
+    // Children: Writers, updating the cache for one second
+    int writers = 2;
+    for (int w = 0; w < writers; w++) {
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid == -1) {
+            perror("fork failed");
+            exit(1);
+        }
+        if (pid == 0) {
+            uint64_t x = 0x9E3779B97F4A7C15ULL * (w + 1);
+            for (double end = now_usec() + 1e6; now_usec() < end;) {
+                down(semid);
+                for (int i = 0; i < 64; i++) { // A batch of updates under one lock
+                    x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+                    c->slots[x % SLOTS]++;
+                    c->total++;
+                }
+                up(semid);
+            }
+            exit(0);
+        }
+    }
+
+    // Parent: Checkpointer, five times a second
+    for (int i = 0; i < 5; i++) {
+        usleep(200000);
+        double paused;
+        pid_t pid = checkpoint(c, sizeof(*c), semid, &paused);
+        printf("Checkpoint %d: writers paused %.0f us, file written in the background\n", i + 1, paused);
+        if (waitpid(pid, NULL, 0) == -1) {
+            perror("waitpid failed");
+            exit(1);
+        }
+    }
+    for (int w = 0; w < writers; w++) {
+        if (wait(NULL) == -1) {
+            perror("wait failed");
+            exit(1);
+        }
+    }
+    double paused;
+    if (waitpid(checkpoint(c, sizeof(*c), semid, &paused), NULL, 0) == -1) { // Final state
+        perror("waitpid failed");
+        exit(1);
+    }
+
+    // Check the snapshot by restoring it into a second segment
+    int checkid = shmget(IPC_PRIVATE, sizeof(struct cache), IPC_CREAT | 0666);
+    struct cache *check = checkid == -1 ? (void *)-1 : shmat(checkid, NULL, 0);
+    if (check == (void *)-1) {
+        perror("shmget/shmat failed");
+        exit(1);
+    }
+    int ok = restore(check, sizeof(*check)) && memcmp(check, c, sizeof(*c)) == 0;
+    printf("Final snapshot: %llu updates, restores identically: %s. Run again for a warm start.\n",
+           (unsigned long long)c->total, ok ? "yes" : "NO");
+
+    if (shmdt(check) == -1 || shmdt(c) == -1) {
+        perror("shmdt failed");
+        exit(1);
+    }
+    if (shmctl(checkid, IPC_RMID, NULL) == -1 || shmctl(shmid, IPC_RMID, NULL) == -1) {
+        perror("Cleaning up (shmctl) failed");
+        exit(1);
+    }
+    if (semctl(semid, 0, IPC_RMID) == -1) {
+        perror("Cleaning up (semctl) failed");
+        exit(1);
+    }
+    return !ok;
+}
@@ -0,0 +1,177 @@
+#include <sys/types.h> // For pid_t
+#include <sys/ipc.h>   // For IPC_PRIVATE, etc.
+#include <sys/shm.h>   // For shared memory functions
+#include <sys/sem.h>   // For semaphore functions
+#include <sys/wait.h>  // For wait
+#include <stdatomic.h> // For atomic_* operations
+#include <stdint.h>    // For uint64_t
+#include <stdio.h>     // For printf, perror
+#include <stdlib.h>    // For exit
+#include <time.h>      // For clock_gettime
+#include <unistd.h>    // For fork
+
+// The "Shared Counter" project, three ways:
+//
+// - exact:   one integer guarded by a semaphore. Every increment is two semop() system calls.
+// - atomic:  one integer incremented with an atomic add. No system calls, but every core
+//            fights over the same cache line.
+// - sharded: every process increments its own slot, padded to a full cache line so no two
+//            slots share one. Writers never contend; a reader sums all slots. The sum may
+//            miss increments that are still in flight, but never counts one twice.
+
+#define MAX_PROCS 64
+#define CACHE_LINE 64
+
+struct slot {
+    _Alignas(CACHE_LINE) _Atomic uint64_t value;
+};
+
+struct counters {
+    uint64_t exact;                      // Guarded by the semaphore
+    _Alignas(CACHE_LINE) _Atomic uint64_t atomic;
+    struct slot shards[MAX_PROCS];
+};
+
+enum mode { EXACT, ATOMIC, SHARDED };
+
+union semun { int val; }; // Union for semctl arguments
+
+// Function to perform a semaphore "down" (decrement) operation
+void down(int semid) {
+    struct sembuf op = {0, -1, 0};
+    if (semop(semid, &op, 1) == -1) {
+        perror("down failed");
+        exit(1);
+    }
+}
+
+// Function to perform a semaphore "up" (increment) operation
+void up(int semid) {
+    struct sembuf op = {0, 1, 0};
+    if (semop(semid, &op, 1) == -1) {
+        perror("up failed");
+        exit(1);
+    }
+}
+
+// Function to add one in the chosen mode; `me` is this process's slot
+void counter_inc(struct counters *c, enum mode mode, int semid, int me) {
+    switch (mode) {
+    case EXACT:
+        down(semid);
+        c->exact++;
+        up(semid);
+        break;
+    case ATOMIC:
+        atomic_fetch_add_explicit(&c->atomic, 1, memory_order_relaxed);
+        break;
+    case SHARDED: {
+        // Only this process writes the slot, so a plain load + store is enough (no locked add)
+        _Atomic uint64_t *v = &c->shards[me].value;
+        atomic_store_explicit(v, atomic_load_explicit(v, memory_order_relaxed) + 1, memory_order_relaxed);
+        break;
+    }
+    }
+}
+
+// Function to read the counter; the sharded mode sums every slot
+uint64_t counter_read(struct counters *c, enum mode mode, int semid) {
+    uint64_t sum = 0;
+    switch (mode) {
+    case EXACT:
+        down(semid);
+        sum = c->exact;
+        up(semid);
+        break;
+    case ATOMIC:
+        sum = atomic_load(&c->atomic);
+        break;
+    case SHARDED:
+        for (int i = 0; i < MAX_PROCS; i++)
+            sum += atomic_load_explicit(&c->shards[i].value, memory_order_relaxed);
+        break;
+    }
+    return sum;
+}
+
+double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+void run(struct counters *c, int semid, enum mode mode, const char *name, int procs, long per_proc) {
+    double start = now_sec();
+    for (int p = 0; p < procs; p++) {
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid == -1) {
+            perror("fork failed");
+            exit(1);
+        }
+        if (pid == 0) { // Child: Incrementer
+            for (long i = 0; i < per_proc; i++)
+                counter_inc(c, mode, semid, p);
+            exit(0);
+        }
+    }
+    for (int p = 0; p < procs; p++) {
+        if (wait(NULL) == -1) {
+            perror("wait failed");
+            exit(1);
+        }
+    }
+    double elapsed = now_sec() - start;
+    uint64_t total = counter_read(c, mode, semid);
+    printf("%-8s %2d procs: total %10llu (expected %10ld)  %7.1f ns/increment  %8.1f M increments/s\n",
+           name, procs, (unsigned long long)total, procs * per_proc,
+           elapsed * 1e9 / (procs * per_proc), procs * per_proc / elapsed / 1e6);
+}
+
+// Usage: shared_memory_counter [processes]
+int main(int argc, char *argv[]) {
+    int procs = argc > 1 ? atoi(argv[1]) : 4;
+    if (procs < 1 || procs > MAX_PROCS) {
+        fprintf(stderr, "processes must be between 1 and %d\n", MAX_PROCS);
+        exit(1);
+    }
+
+    int shmid = shmget(IPC_PRIVATE, sizeof(struct counters), IPC_CREAT | 0666);
+    if (shmid == -1) {
+        perror("shmget failed");
+        exit(1);
+    }
+    struct counters *c = shmat(shmid, NULL, 0); // Attached before fork: children inherit it
+    if (c == (void *)-1) {
+        perror("shmat failed");
+        exit(1);
+    }
+    int semid = semget(IPC_PRIVATE, 1, IPC_CREAT | 0666);
+    if (semid == -1) {
+        perror("semget failed");
+        exit(1);
+    }
+    union semun arg = {1}; // Binary semaphore, initially unlocked
+    if (semctl(semid, 0, SETVAL, arg) == -1) {
+        perror("semctl failed");
+        exit(1);
+    }
+
+    run(c, semid, EXACT, "exact", procs, 200000); // Fewer rounds: each one is two system calls
+    run(c, semid, ATOMIC, "atomic", procs, 5000000);
+    run(c, semid, SHARDED, "sharded", procs, 5000000);
+
+    if (semctl(semid, 0, IPC_RMID) == -1) {
+        perror("Cleaning up (semctl) failed");
+        exit(1);
+    }
+    if (shmdt(c) == -1) {
+        perror("shmdt failed");
+        exit(1);
+    }
+    if (shmctl(shmid, IPC_RMID, NULL) == -1) {
+        perror("Cleaning up (shmctl) failed");
+        exit(1);
+    }
+    return 0;
+}
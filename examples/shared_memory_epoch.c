@@ -0,0 +1,358 @@
+#include <sys/types.h> // For pid_t
+#include <sys/ipc.h>   // For IPC_PRIVATE, etc.
+#include <sys/shm.h>   // For shared memory functions
+#include <sys/wait.h>  // For wait
+#include <errno.h>     // For errno, ESRCH
+#include <signal.h>    // For kill, raise, SIGKILL
+#include <stdatomic.h> // For atomic_* operations
+#include <stddef.h>    // For offsetof
+#include <stdint.h>    // For uint32_t, uint64_t
+#include <stdio.h>     // For printf, perror
+#include <string.h>    // For memset
+#include <stdlib.h>    // For exit
+#include <time.h>      // For clock_gettime
+#include <sched.h>     // For sched_yield
+#include <unistd.h>    // For fork, getpid
+
+// Epoch-based reclamation (EBR) for lock-free structures in shared memory.
+//
+// When a writer unlinks an object from a lock-free structure, readers in other processes
+// may still be looking at it, so it can't be freed (and reused) right away. With EBR each
+// process announces the global epoch in its slot while it reads (ebr_enter/ebr_exit).
+// Retired objects go on the retiring process's deferred list for the current epoch, and the
+// epoch only advances once every active process has announced it. An object retired in
+// epoch E is therefore unreachable for everyone by epoch E + 2, and is freed then.
+//
+// Everything lives in the segment, so a process that dies stays visible: its slot would
+// hold the epoch back forever if it died in a read section (and nothing could be freed
+// again), and in any case keeps its slot and its deferred lists. ebr_try_advance() checks
+// the owner of every other slot in use with kill(pid, 0), and reaps it if the process is
+// gone, adopting its deferred lists; ebr_register() takes over a dead process's slot, lists
+// included, when none is free. Pid reuse could hide a death; a real service would also
+// record the process start time.
+//
+// Objects are identified by their offset in the segment and must start with an 8-byte
+// link field, which EBR uses for its deferred lists.
+
+#define MAX_PARTICIPANTS 16
+#define ACTIVE 1 // Low bit of an announced epoch (epochs are stored << 1)
+#define REAPING -1
+
+struct ebr_slot {
+    _Alignas(64) _Atomic int pid;   // 0 = free
+    _Atomic uint64_t epoch;         // (epoch << 1) | ACTIVE while inside a read section
+    uint64_t limbo[3];              // Deferred lists, by epoch % 3 (offsets, 0 = empty)
+    uint64_t limbo_epoch[3];
+};
+
+struct ebr {
+    _Alignas(64) _Atomic uint64_t global;
+    _Atomic long reaped;            // Dead participants reaped (statistics)
+    struct ebr_slot slots[MAX_PARTICIPANTS];
+};
+
+// Process-local handle
+struct ebr_handle {
+    struct ebr *ebr;
+    char *base;                                  // Segment address in this process
+    void (*reclaim)(char *base, uint64_t offset);
+    struct ebr_slot *slot;
+    long retired, freed;
+};
+
+int dead(int pid) {
+    return pid > 0 && kill(pid, 0) == -1 && errno == ESRCH;
+}
+
+// Function to take a slot in the segment; returns 0 if all are in use by live processes
+int ebr_register(struct ebr_handle *h, struct ebr *e, char *base, void (*reclaim)(char *, uint64_t)) {
+    *h = (struct ebr_handle){e, base, reclaim, NULL, 0, 0};
+    for (int i = 0; i < MAX_PARTICIPANTS; i++) {
+        int free_pid = 0;
+        if (atomic_compare_exchange_strong(&e->slots[i].pid, &free_pid, getpid())) {
+            h->slot = &e->slots[i];
+            return 1;
+        }
+    }
+    for (int i = 0; i < MAX_PARTICIPANTS; i++) { // None free: take over a dead process's slot
+        int pid = atomic_load(&e->slots[i].pid);
+        if (dead(pid) && atomic_compare_exchange_strong(&e->slots[i].pid, &pid, getpid())) {
+            h->slot = &e->slots[i];
+            atomic_store(&h->slot->epoch, 0); // Its deferred lists keep their epochs and become ours
+            atomic_fetch_add(&e->reaped, 1);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Function to start a read section: pointers loaded until ebr_exit stay valid
+void ebr_enter(struct ebr_handle *h) {
+    uint64_t e = atomic_load(&h->ebr->global);
+    atomic_store(&h->slot->epoch, e << 1 | ACTIVE); // seq_cst: visible before we load any pointer
+}
+
+void ebr_exit(struct ebr_handle *h) {
+    atomic_store_explicit(&h->slot->epoch, 0, memory_order_release);
+}
+
+void free_list(struct ebr_handle *h, uint64_t offset) {
+    while (offset) {
+        uint64_t next = *(uint64_t *)(h->base + offset);
+        h->reclaim(h->base, offset);
+        h->freed++;
+        offset = next;
+    }
+}
+
+// Function to free our deferred lists that are at least two epochs old
+void ebr_collect(struct ebr_handle *h) {
+    uint64_t global = atomic_load(&h->ebr->global);
+    for (int b = 0; b < 3; b++) {
+        if (h->slot->limbo[b] && h->slot->limbo_epoch[b] + 2 <= global) {
+            free_list(h, h->slot->limbo[b]);
+            h->slot->limbo[b] = 0;
+        }
+    }
+}
+
+// Function to hand a dead participant's deferred objects to us (as if retired now)
+void reap(struct ebr_handle *h, struct ebr_slot *dead) {
+    uint64_t global = atomic_load(&h->ebr->global);
+    struct ebr_slot *me = h->slot;
+    int b = global % 3;
+    if (me->limbo[b] && me->limbo_epoch[b] != global) {
+        free_list(h, me->limbo[b]); // At least three epochs old
+        me->limbo[b] = 0;
+    }
+    for (int i = 0; i < 3; i++) {
+        for (uint64_t offset = dead->limbo[i], next; offset; offset = next) {
+            next = *(uint64_t *)(h->base + offset);
+            *(uint64_t *)(h->base + offset) = me->limbo[b];
+            me->limbo[b] = offset;
+        }
+        dead->limbo[i] = 0;
+    }
+    me->limbo_epoch[b] = global;
+    atomic_store(&dead->epoch, 0);
+    atomic_store(&dead->pid, 0);
+    atomic_fetch_add(&h->ebr->reaped, 1);
+}
+
+// Function to advance the global epoch if every active participant has seen it. Reaps
+// every dead participant on the way, whether or not it died inside a read section.
+int ebr_try_advance(struct ebr_handle *h) {
+    struct ebr *e = h->ebr;
+    uint64_t global = atomic_load(&e->global);
+    int blocked = 0;
+    for (int i = 0; i < MAX_PARTICIPANTS; i++) {
+        struct ebr_slot *s = &e->slots[i];
+        int pid = atomic_load(&s->pid);
+        if (s == h->slot || pid <= 0)
+            continue;
+        if (dead(pid) && atomic_compare_exchange_strong(&s->pid, &pid, REAPING)) {
+            reap(h, s);
+            continue;
+        }
+        uint64_t seen = atomic_load(&s->epoch);
+        if ((seen & ACTIVE) && seen >> 1 != global)
+            blocked = 1;
+    }
+    return !blocked && atomic_compare_exchange_strong(&e->global, &global, global + 1);
+}
+
+// Function to defer freeing an object that is no longer reachable
+void ebr_retire(struct ebr_handle *h, uint64_t offset) {
+    uint64_t global = atomic_load(&h->ebr->global);
+    struct ebr_slot *s = h->slot;
+    int b = global % 3;
+    if (s->limbo[b] && s->limbo_epoch[b] != global) {
+        free_list(h, s->limbo[b]); // Retired three or more epochs ago
+        s->limbo[b] = 0;
+    }
+    *(uint64_t *)(h->base + offset) = s->limbo[b];
+    s->limbo[b] = offset;
+    s->limbo_epoch[b] = global;
+    h->retired++;
+    if (h->retired % 64 == 0) {
+        ebr_try_advance(h);
+        ebr_collect(h);
+    }
+}
+
+int limbo_empty(struct ebr_slot *s) {
+    return !s->limbo[0] && !s->limbo[1] && !s->limbo[2];
+}
+
+// Function to give up our slot once everything we retired (or adopted by reaping) is freed
+void ebr_unregister(struct ebr_handle *h) {
+    ebr_exit(h);
+    for (;;) {
+        ebr_try_advance(h);
+        ebr_collect(h);
+        if (limbo_empty(h->slot))
+            break;
+        sched_yield(); // Let a reader that holds the epoch back finish its read section
+    }
+    atomic_store(&h->slot->pid, 0);
+}
+
+// The demo structure: one shared record, replaced wholesale by the writer (read-copy-update)
+#define NODES 4096
+#define POISON 0xDDDDDDDDDDDDDDDDULL
+
+struct record {
+    uint64_t link;        // For EBR and the free stack
+    uint64_t version;
+    uint64_t values[6];   // All equal to version in a valid record
+};
+
+struct shared {
+    struct ebr ebr;
+    _Alignas(64) _Atomic uint64_t current;  // Offset of the live record
+    _Alignas(64) _Atomic uint64_t free_top; // (generation << 32) | free record index + 1
+    _Atomic uint64_t free_count;
+    struct record records[NODES];
+};
+
+uint64_t record_offset(int index) {
+    return offsetof(struct shared, records) + (uint64_t)index * sizeof(struct record);
+}
+
+// Function to return a record to the free stack (the EBR reclaim callback); poisons it first
+void record_free(char *base, uint64_t offset) {
+    struct shared *sh = (struct shared *)base;
+    struct record *r = (struct record *)(base + offset);
+    memset(r, 0xDD, sizeof(*r));
+    uint32_t index = (offset - offsetof(struct shared, records)) / sizeof(struct record);
+    uint64_t old = atomic_load(&sh->free_top), new;
+    do {
+        r->link = (uint32_t)old;
+        new = ((old >> 32) + 1) << 32 | (index + 1);
+    } while (!atomic_compare_exchange_weak(&sh->free_top, &old, new));
+    atomic_fetch_add(&sh->free_count, 1);
+}
+
+// Function to take a record from the free stack; returns 0 when it is empty
+uint64_t record_alloc(struct shared *sh) {
+    uint64_t old = atomic_load(&sh->free_top), new;
+    do {
+        uint32_t ref = (uint32_t)old;
+        if (ref == 0)
+            return 0;
+        new = ((old >> 32) + 1) << 32 | (uint32_t)sh->records[ref - 1].link;
+    } while (!atomic_compare_exchange_weak(&sh->free_top, &old, new));
+    atomic_fetch_sub(&sh->free_count, 1);
+    return record_offset((uint32_t)old - 1);
+}
+
+double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main() {
+    int shmid = shmget(IPC_PRIVATE, sizeof(struct shared), IPC_CREAT | 0666);
+    if (shmid == -1) {
+        perror("shmget failed");
+        exit(1);
+    }
+    char *base = shmat(shmid, NULL, 0); // Attached before fork: children inherit it
+    if (base == (void *)-1) {
+        perror("shmat failed");
+        exit(1);
+    }
+    struct shared *sh = (struct shared *)base;
+    for (int i = 0; i < NODES; i++)
+        record_free(base, record_offset(i));
+    uint64_t first = record_alloc(sh);
+    struct record *r = (struct record *)(base + first);
+    r->version = 0;
+    for (int k = 0; k < 6; k++)
+        r->values[k] = 0;
+    atomic_store(&sh->current, first);
+
+    // Children: Readers (reader 0 "crashes" inside a read section after a while) and two
+    // writers (the second one crashes outside any read section, with records still deferred)
+    int readers = 3, children = readers + 2;
+    for (int i = 0; i < children; i++) {
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid == -1) {
+            perror("fork failed");
+            exit(1);
+        }
+        if (pid != 0)
+            continue;
+        struct ebr_handle h;
+        if (!ebr_register(&h, &sh->ebr, base, record_free)) {
+            fprintf(stderr, "no free EBR slot\n");
+            exit(1);
+        }
+        if (i >= readers) { // Writer: replaces the record as fast as it can
+            long writes = 0, stalls = 0;
+            for (double end = now_sec() + 1; now_sec() < end; writes++) {
+                if (i == readers + 1 && writes == 1000)
+                    raise(SIGKILL); // Dies with its deferred lists full
+                uint64_t offset;
+                while (!(offset = record_alloc(sh))) { // Everything awaits reclamation: push the epoch
+                    stalls++;
+                    ebr_try_advance(&h);
+                    ebr_collect(&h);
+                    sched_yield();
+                }
+                struct record *n = (struct record *)(base + offset);
+                n->version = writes + 1;
+                for (int k = 0; k < 6; k++)
+                    n->values[k] = writes + 1;
+                uint64_t old = atomic_exchange(&sh->current, offset);
+                ebr_retire(&h, old);
+            }
+            printf("Writer: %ld records replaced, %ld freed, %lu epochs, %ld waits for a free record\n",
+                   writes, h.freed, (unsigned long)atomic_load(&sh->ebr.global), stalls);
+            ebr_unregister(&h);
+            exit(0);
+        }
+        long reads = 0, torn = 0;
+        for (double end = now_sec() + 1; now_sec() < end; reads++) {
+            ebr_enter(&h);
+            struct record *cur = (struct record *)(base + atomic_load(&sh->current));
+            uint64_t v = cur->version;
+            for (int k = 0; k < 6; k++)
+                torn += cur->values[k] != v || v == POISON;
+            if (i == 0 && reads == 100000)
+                raise(SIGKILL); // Dies holding an old epoch
+            ebr_exit(&h);
+        }
+        printf("Reader %d: %ld reads, %ld saw a freed or torn record\n", i, reads, torn);
+        ebr_unregister(&h);
+        exit(torn != 0);
+    }
+
+    // Parent: waits for whichever child finishes first. A dead child stays a zombie, and
+    // kill() still finds it, until its parent has waited for it.
+    int failed = 0;
+    for (int i = 0; i < children; i++) {
+        int status;
+        if (wait(&status) == -1) {
+            perror("wait failed");
+            exit(1);
+        }
+        failed |= WIFEXITED(status) && WEXITSTATUS(status) != 0;
+    }
+    // Every record but the live one is free again, including those the dead writer retired
+    long reaped = atomic_load(&sh->ebr.reaped), free_records = atomic_load(&sh->free_count);
+    printf("Crashed participants reaped: %ld of 2, records free: %ld of %d\n", reaped, free_records, NODES - 1);
+    failed |= reaped != 2 || free_records != NODES - 1;
+
+    if (shmdt(base) == -1) {
+        perror("shmdt failed");
+        exit(1);
+    }
+    if (shmctl(shmid, IPC_RMID, NULL) == -1) {
+        perror("Cleaning up (shmctl) failed");
+        exit(1);
+    }
+    return failed;
+}
@@ -0,0 +1,207 @@
+#include <sys/types.h> // For pid_t
+#include <sys/ipc.h>   // For IPC_PRIVATE, etc.
+#include <sys/shm.h>   // For shared memory functions
+#include <sys/wait.h>  // For wait
+#include <stdatomic.h> // For atomic_* operations
+#include <stdint.h>    // For uint32_t, uint64_t
+#include <stdio.h>     // For printf, perror, snprintf
+#include <string.h>    // For memcpy, strcmp, strlen, strncmp
+#include <stdlib.h>    // For exit
+#include <time.h>      // For clock_gettime
+#include <unistd.h>    // For fork
+#include <sched.h>     // For sched_yield
+
+// A fixed-capacity cache shared by many processes ("Database Caching" from the guide).
+//
+// - Open addressing: a key may live in any of the PROBE buckets starting at hash % CAPACITY.
+// - Lookups take no lock. Each bucket has a version counter that is odd while a writer is
+//   inside it; a reader copies the bucket and retries if the version changed meanwhile.
+// - Writers claim a bucket by CAS-ing its version from even to odd, so two writers can
+//   never modify the same bucket at once, and nobody ever blocks a reader.
+// - When the probe window is full, CLOCK (second chance) picks the victim: a hit sets the
+//   bucket's referenced bit, and the evictor skips referenced buckets once, clearing the bit.
+// - Keys are stored whole: one of KEY_LEN characters or more is rejected by table_put (and
+//   never found by table_get) rather than truncated into a different key.
+
+#define CAPACITY 4096 // Must be a power of two
+#define PROBE 8
+#define KEY_LEN 48
+#define VALUE_LEN 64
+
+struct bucket {
+    _Atomic uint32_t version;    // Odd while being written
+    _Atomic uint32_t referenced; // CLOCK bit
+    uint64_t hash;               // 0 means empty
+    char key[KEY_LEN];
+    char value[VALUE_LEN];
+};                               // 128 bytes: two whole cache lines, never shared with a neighbour
+
+struct table {
+    struct bucket buckets[CAPACITY];
+};
+
+uint64_t hash_key(const char *key) {
+    uint64_t h = 1469598103934665603ULL; // FNV-1a
+    for (; *key; key++)
+        h = (h ^ (unsigned char)*key) * 1099511628211ULL;
+    return h ? h : 1; // 0 is reserved for "empty"
+}
+
+// Function to look a key up without locking; returns 1 and copies the value on a hit
+int table_get(struct table *t, const char *key, char *value) {
+    if (strlen(key) >= KEY_LEN)
+        return 0; // Too long to have been stored
+    uint64_t h = hash_key(key);
+    for (int i = 0; i < PROBE; i++) {
+        struct bucket *b = &t->buckets[(h + i) & (CAPACITY - 1)];
+        for (int spins = 0;; spins++) {
+            if (spins > 100)
+                sched_yield(); // The writer may have been preempted mid-update
+            uint32_t v1 = atomic_load_explicit(&b->version, memory_order_acquire);
+            if (v1 & 1)
+                continue; // A writer is inside; try again
+            uint64_t bh = b->hash;
+            int match = bh == h && strncmp(b->key, key, KEY_LEN) == 0;
+            if (match)
+                memcpy(value, b->value, VALUE_LEN);
+            atomic_thread_fence(memory_order_acquire);
+            if (atomic_load_explicit(&b->version, memory_order_relaxed) != v1)
+                continue; // Torn copy; read the bucket again
+            if (!match)
+                break;
+            if (!atomic_load_explicit(&b->referenced, memory_order_relaxed)) // Avoid dirtying the line on every hit
+                atomic_store_explicit(&b->referenced, 1, memory_order_relaxed);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Function to claim a bucket for writing; fails if another writer holds it
+int try_claim(struct bucket *b, uint32_t *version) {
+    uint32_t v = atomic_load_explicit(&b->version, memory_order_relaxed);
+    if ((v & 1) || !atomic_compare_exchange_strong(&b->version, &v, v + 1))
+        return 0;
+    *version = v;
+    return 1;
+}
+
+void release(struct bucket *b, uint32_t version) {
+    atomic_store_explicit(&b->version, version + 2, memory_order_release);
+}
+
+// Function to insert or update a key. Prefers the bucket already holding the key, then an
+// empty bucket, then a CLOCK victim. Two processes inserting the same new key at the same
+// moment can both succeed; the duplicate is harmless for a cache and ages out normally.
+// Returns 0 without storing anything if the key is KEY_LEN characters or longer.
+int table_put(struct table *t, const char *key, const char *value) {
+    size_t len = strlen(key);
+    if (len >= KEY_LEN)
+        return 0;
+    uint64_t h = hash_key(key);
+    for (;;) {
+        struct bucket *target = NULL, *empty = NULL;
+        for (int i = 0; i < PROBE && !target; i++) {
+            struct bucket *b = &t->buckets[(h + i) & (CAPACITY - 1)];
+            if (b->hash == h && strncmp(b->key, key, KEY_LEN) == 0)
+                target = b;
+            else if (b->hash == 0 && !empty)
+                empty = b;
+        }
+        if (!target)
+            target = empty;
+        for (int sweep = 0; !target && sweep < 2 * PROBE; sweep++) {
+            struct bucket *b = &t->buckets[(h + sweep % PROBE) & (CAPACITY - 1)];
+            if (atomic_exchange_explicit(&b->referenced, 0, memory_order_relaxed) == 0)
+                target = b; // Not used since the hand last passed: evict it
+        }
+        if (!target)
+            target = &t->buckets[h & (CAPACITY - 1)];
+
+        uint32_t v;
+        if (!try_claim(target, &v))
+            continue; // Another writer got there first; look again
+        target->hash = h;
+        memcpy(target->key, key, len + 1);
+        memcpy(target->value, value, VALUE_LEN);
+        atomic_store_explicit(&target->referenced, 1, memory_order_relaxed);
+        release(target, v);
+        return 1;
+    }
+}
+
+double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main() {
+    int shmid = shmget(IPC_PRIVATE, sizeof(struct table), IPC_CREAT | 0666); // Fresh segments are zeroed: all buckets empty
+    if (shmid == -1) {
+        perror("shmget failed");
+        exit(1);
+    }
+
+    int workers = 4, ops = 1000000, keys = 2 * CAPACITY; // More keys than buckets, so eviction runs
+    for (int w = 0; w < workers; w++) {
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid == -1) {
+            perror("fork failed");
+            exit(1);
+        }
+        if (pid == 0) { // Child: Worker with a skewed access pattern
+            struct table *t = shmat(shmid, NULL, 0);
+            if (t == (void *)-1) {
+                perror("shmat failed");
+                exit(1);
+            }
+            uint64_t x = 0x9E3779B97F4A7C15ULL * (w + 1);
+            long hits = 0, bad = 0;
+            char long_key[KEY_LEN + 16], stored[VALUE_LEN] = "never stored";
+            memset(long_key, 'k', sizeof(long_key) - 1);
+            long_key[sizeof(long_key) - 1] = '\0';
+            bad += table_put(t, long_key, stored) || table_get(t, long_key, stored); // Rejected, not truncated
+            double start = now_sec();
+            for (int i = 0; i < ops; i++) {
+                x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+                int k = (int)((x >> 8) % ((x & 3) ? keys / 8 : keys)); // 75% of lookups hit a hot eighth of the keys
+                char key[KEY_LEN], expect[VALUE_LEN], value[VALUE_LEN];
+                snprintf(key, sizeof(key), "user:%d", k);
+                memset(expect, 0, sizeof(expect));
+                snprintf(expect, sizeof(expect), "profile of user %d", k);
+                if (table_get(t, key, value)) {
+                    hits++;
+                    bad += strcmp(value, expect) != 0;
+                } else {
+                    table_put(t, key, expect); // Miss: "load from the database" and cache it
+                }
+            }
+            double elapsed = now_sec() - start;
+            printf("Worker %d: %.1f%% hits, %.0f ns/op, %ld inconsistent reads\n",
+                   w, 100.0 * hits / ops, elapsed * 1e9 / ops, bad);
+            if (shmdt(t) == -1) {
+                perror("shmdt failed");
+                exit(1);
+            }
+            exit(bad != 0);
+        }
+    }
+
+    // Parent: wait for every worker, then remove the segment
+    int failed = 0;
+    for (int w = 0; w < workers; w++) {
+        int status;
+        if (wait(&status) == -1) {
+            perror("wait failed");
+            exit(1);
+        }
+        failed |= !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+    }
+    if (shmctl(shmid, IPC_RMID, NULL) == -1) {
+        perror("Cleaning up (shmctl) failed");
+        exit(1);
+    }
+    return failed;
+}
@@ -0,0 +1,251 @@
+#include <sys/types.h> // For pid_t
+#include <sys/ipc.h>   // For IPC_PRIVATE, etc.
+#include <sys/shm.h>   // For shared memory functions
+#include <sys/wait.h>  // For wait
+#include <stdatomic.h> // For atomic_* operations
+#include <stdint.h>    // For uint32_t, uint64_t, intptr_t
+#include <stdio.h>     // For printf, perror, snprintf
+#include <string.h>    // For memset, memcpy, strcmp
+#include <stdlib.h>    // For exit
+#include <unistd.h>    // For fork
+
+// A heap allocator that lives inside one shared memory segment.
+//
+// - Every allocation is named by its offset from the segment base (shm_off), so the same
+//   value works in every process no matter where shmat() put the segment.
+// - Blocks come in power-of-two size classes (16 .. 4096 bytes). Freed blocks go onto a
+//   per-class free list in the segment: a lock-free stack whose head carries a tag that
+//   changes on every update, so a stale compare-and-swap can't succeed (the ABA problem).
+// - Each process keeps a small private cache per class and only touches the shared lists
+//   in batches, so most allocations and frees don't write shared cache lines at all.
+// - struct offset_ptr is a self-relative pointer for links stored inside the segment.
+
+#define HEAP_SIZE (4 << 20)
+#define MIN_SHIFT 4           // Smallest class: 16 bytes
+#define NUM_CLASSES 9         // 16, 32, ..., 4096 bytes
+#define CACHE_SIZE 32         // Blocks per class held privately by each process
+#define BATCH (CACHE_SIZE / 2)
+#define HEADER_SIZE 16        // Per-block header, keeps payloads 16-byte aligned
+#define MAX_WRITERS 8
+
+typedef uint32_t shm_off;     // 0 means "null"
+
+// Function-like macro to turn an offset into a typed pointer in this process
+#define SHM_PTR(heap, off, type) ((type *)((off) ? (heap)->base + (off) : NULL))
+
+// A pointer that stores the distance from itself to its target.
+// Valid in every mapping of the segment because both ends move together.
+struct offset_ptr { intptr_t delta; }; // 0 means "null" (a link never points to itself)
+
+void op_set(struct offset_ptr *p, const void *target) {
+    p->delta = target ? (intptr_t)target - (intptr_t)p : 0;
+}
+
+void *op_get(const struct offset_ptr *p) {
+    return p->delta ? (char *)p + p->delta : NULL;
+}
+
+struct heap_header {
+    _Atomic uint64_t free_lists[NUM_CLASSES]; // (tag << 32) | offset of the first free block
+    _Atomic uint32_t top;                      // Bump pointer for never-used memory
+    _Atomic shm_off roots[MAX_WRITERS];        // Demo data: one list per writer
+};
+
+struct block_header {
+    uint32_t size_class;
+    uint32_t pad[3];
+};
+
+// Process-local view of the heap: where it is attached plus the private caches
+struct heap {
+    char *base;
+    struct heap_header *header;
+    shm_off cache[NUM_CLASSES][CACHE_SIZE];
+    int cached[NUM_CLASSES];
+};
+
+void heap_attach(struct heap *h, int shmid) {
+    h->base = shmat(shmid, NULL, 0);
+    if (h->base == (void *)-1) {
+        perror("shmat failed");
+        exit(1);
+    }
+    h->header = (struct heap_header *)h->base;
+    memset(h->cached, 0, sizeof(h->cached));
+}
+
+int size_to_class(size_t size) {
+    int c = 0;
+    while (c < NUM_CLASSES && ((size_t)1 << (c + MIN_SHIFT)) < size + HEADER_SIZE)
+        c++;
+    return c;
+}
+
+// The next-free link of a free block is kept in its (unused) payload
+shm_off *next_free(struct heap *h, shm_off block) {
+    return (shm_off *)(h->base + block + HEADER_SIZE);
+}
+
+void global_push(struct heap *h, int c, shm_off block) {
+    _Atomic uint64_t *list = &h->header->free_lists[c];
+    uint64_t old = atomic_load(list), new;
+    do {
+        *next_free(h, block) = (shm_off)old;
+        new = ((old >> 32) + 1) << 32 | block;
+    } while (!atomic_compare_exchange_weak(list, &old, new));
+}
+
+shm_off global_pop(struct heap *h, int c) {
+    _Atomic uint64_t *list = &h->header->free_lists[c];
+    uint64_t old = atomic_load(list), new;
+    do {
+        shm_off block = (shm_off)old;
+        if (block == 0)
+            return 0;
+        // May read a link another process just changed; the tag makes the CAS fail then.
+        new = ((old >> 32) + 1) << 32 | *next_free(h, block);
+    } while (!atomic_compare_exchange_weak(list, &old, new));
+    return (shm_off)old;
+}
+
+// Function to refill a private cache: reuse freed blocks first, else carve fresh memory
+void refill(struct heap *h, int c) {
+    while (h->cached[c] < BATCH) {
+        shm_off block = global_pop(h, c);
+        if (block == 0)
+            break;
+        h->cache[c][h->cached[c]++] = block;
+    }
+    if (h->cached[c] > 0)
+        return;
+    uint32_t block_size = 1u << (c + MIN_SHIFT);
+    uint32_t start = atomic_fetch_add(&h->header->top, block_size * BATCH); // One atomic for the batch
+    if (start + block_size * BATCH > HEAP_SIZE) {
+        fprintf(stderr, "shared heap exhausted\n");
+        exit(1);
+    }
+    for (int i = 0; i < BATCH; i++) {
+        shm_off block = start + i * block_size;
+        SHM_PTR(h, block, struct block_header)->size_class = c;
+        h->cache[c][h->cached[c]++] = block;
+    }
+}
+
+// Function to allocate `size` bytes; returns the payload offset (0 if too large)
+shm_off shm_alloc(struct heap *h, size_t size) {
+    int c = size_to_class(size);
+    if (c == NUM_CLASSES)
+        return 0;
+    if (h->cached[c] == 0)
+        refill(h, c);
+    return h->cache[c][--h->cached[c]] + HEADER_SIZE;
+}
+
+// Function to free a payload offset returned by shm_alloc
+void shm_free(struct heap *h, shm_off off) {
+    shm_off block = off - HEADER_SIZE;
+    int c = SHM_PTR(h, block, struct block_header)->size_class;
+    if (h->cached[c] == CACHE_SIZE) { // Cache full: hand half back to everyone else
+        while (h->cached[c] > BATCH)
+            global_push(h, c, h->cache[c][--h->cached[c]]);
+    }
+    h->cache[c][h->cached[c]++] = block;
+}
+
+// Function to return every privately cached block (call before a process exits)
+void shm_flush(struct heap *h) {
+    for (int c = 0; c < NUM_CLASSES; c++)
+        while (h->cached[c] > 0)
+            global_push(h, c, h->cache[c][--h->cached[c]]);
+}
+
+struct node {
+    struct offset_ptr next;
+    int writer;
+    int seq;
+    char text[];
+};
+
+int main() {
+    int shmid = shmget(IPC_PRIVATE, HEAP_SIZE, IPC_CREAT | 0666);
+    if (shmid == -1) {
+        perror("shmget failed");
+        exit(1);
+    }
+    struct heap h;
+    heap_attach(&h, shmid);
+    memset(h.header, 0, sizeof(struct heap_header));
+    atomic_store(&h.header->top, (sizeof(struct heap_header) + 63) & ~63u);
+
+    int writers = 4, per_writer = 2000;
+    for (int w = 0; w < writers; w++) {
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid == -1) {
+            perror("fork failed");
+            exit(1);
+        }
+        if (pid == 0) { // Child: Writer
+            struct node *head = NULL;
+            for (int i = 0; i < per_writer; i++) {
+                char text[200];
+                int len = snprintf(text, sizeof(text), "writer %d item %d ", w, i);
+                int pad = (i * 7) % 150; // Vary the size so nodes land in different classes
+                memset(text + len, '.', pad);
+                len += pad;
+                text[len] = '\0';
+                shm_off off = shm_alloc(&h, sizeof(struct node) + len + 1);
+                struct node *n = SHM_PTR(&h, off, struct node);
+                n->writer = w;
+                n->seq = i;
+                memcpy(n->text, text, len + 1);
+                if (i % 2) { // Churn: free every other node straight away
+                    shm_free(&h, off);
+                    continue;
+                }
+                op_set(&n->next, head);
+                head = n;
+            }
+            atomic_store(&h.header->roots[w], head ? (shm_off)((char *)head - h.base) : 0);
+            shm_flush(&h);
+            exit(0);
+        }
+    }
+
+    // Parent: Reader
+    for (int w = 0; w < writers; w++) {
+        if (wait(NULL) == -1) {
+            perror("wait failed");
+            exit(1);
+        }
+    }
+    // Attach a second time: same offsets, different address
+    struct heap other;
+    heap_attach(&other, shmid);
+    printf("Segment attached at %p and %p\n", (void *)h.base, (void *)other.base);
+    for (int w = 0; w < writers; w++) {
+        int count = 0;
+        shm_off root = atomic_load(&h.header->roots[w]);
+        struct node *a = SHM_PTR(&h, root, struct node);
+        struct node *b = SHM_PTR(&other, root, struct node);
+        for (; a && b; a = op_get(&a->next), b = op_get(&b->next)) {
+            if (a->seq != b->seq || strcmp(a->text, b->text) != 0) {
+                fprintf(stderr, "mappings disagree\n");
+                exit(1);
+            }
+            count++;
+        }
+        printf("Writer %d: %d nodes, identical through both mappings\n", w, count);
+    }
+    printf("Bytes carved from the segment: %u (freed blocks were reused)\n", atomic_load(&h.header->top));
+
+    if (shmdt(other.base) == -1 || shmdt(h.base) == -1) {
+        perror("shmdt failed");
+        exit(1);
+    }
+    if (shmctl(shmid, IPC_RMID, NULL) == -1) {
+        perror("Cleaning up (shmctl) failed");
+        exit(1);
+    }
+    return 0;
+}
@@ -0,0 +1,186 @@
+#define _GNU_SOURCE            // For MADV_HUGEPAGE, SHM_HUGETLB
+#include <sys/types.h>         // For pid_t
+#include <sys/ipc.h>           // For IPC_PRIVATE, etc.
+#include <sys/shm.h>           // For shared memory functions, SHM_HUGETLB
+#include <sys/mman.h>          // For madvise
+#include <sys/wait.h>          // For waitpid
+#include <sys/ioctl.h>         // For ioctl
+#include <sys/syscall.h>       // For SYS_perf_event_open
+#include <linux/perf_event.h>  // For perf_event_attr
+#include <stdio.h>             // For printf, perror
+#include <string.h>            // For memset, strcmp
+#include <stdlib.h>            // For exit, strtoul
+#include <stdint.h>            // For uint64_t
+#include <time.h>              // For clock_gettime
+#include <unistd.h>            // For fork
+
+#ifndef SHM_HUGE_SHIFT
+#define SHM_HUGE_SHIFT 26
+#endif
+#ifndef SHM_HUGE_2MB
+#define SHM_HUGE_2MB (21 << SHM_HUGE_SHIFT) // log2(2 MiB) encoded in the flags
+#endif
+#ifndef SHM_HUGE_1GB
+#define SHM_HUGE_1GB (30 << SHM_HUGE_SHIFT) // log2(1 GiB) encoded in the flags
+#endif
+
+#define MIB (1024UL * 1024UL)
+#define ACCESSES (16UL * 1024UL * 1024UL) // Random reads per benchmark run
+
+// PAGES_FALLBACK_THP: a SHM_HUGETLB request fell back to normal pages with a THP hint
+enum page_mode { PAGES_NORMAL, PAGES_HUGE_2MB, PAGES_HUGE_1GB, PAGES_FALLBACK_THP };
+
+const char *mode_name(enum page_mode mode) {
+    switch (mode) {
+    case PAGES_HUGE_2MB:     return "huge 2MiB";
+    case PAGES_HUGE_1GB:     return "huge 1GiB";
+    case PAGES_FALLBACK_THP: return "fallback+THP hint";
+    default:                 return "normal 4KiB";
+    }
+}
+
+size_t round_up(size_t size, size_t align) {
+    return (size + align - 1) / align * align;
+}
+
+// Function to create a segment with the requested page size.
+// If no huge pages are reserved (shmget fails), it falls back to normal pages and
+// reports the mode it actually got through *got (PAGES_FALLBACK_THP in that case).
+int create_segment(size_t *size, enum page_mode mode, enum page_mode *got) {
+    if (mode != PAGES_NORMAL) {
+        int huge = (mode == PAGES_HUGE_1GB) ? SHM_HUGE_1GB : SHM_HUGE_2MB;
+        size_t page = (mode == PAGES_HUGE_1GB) ? 1024 * MIB : 2 * MIB;
+        size_t huge_size = round_up(*size, page); // Must be a multiple of the huge page size
+        int shmid = shmget(IPC_PRIVATE, huge_size, IPC_CREAT | SHM_HUGETLB | huge | 0666);
+        if (shmid != -1) {
+            *size = huge_size;
+            *got = mode;
+            return shmid;
+        }
+        perror("shmget(SHM_HUGETLB) failed, falling back to normal pages");
+    }
+    int shmid = shmget(IPC_PRIVATE, *size, IPC_CREAT | 0666);
+    if (shmid == -1) {
+        perror("shmget failed");
+        exit(1);
+    }
+    *got = mode == PAGES_NORMAL ? PAGES_NORMAL : PAGES_FALLBACK_THP;
+    return shmid;
+}
+
+// Function to attach a segment. Fallback segments get an madvise hint so the kernel can
+// still back them with transparent huge pages when shmem THP is set to "advise"; the
+// PAGES_NORMAL baseline gets none, so it really measures 4 KiB pages.
+void *attach_segment(int shmid, size_t size, enum page_mode got) {
+    void *shmaddr = shmat(shmid, NULL, 0);
+    if (shmaddr == (void *)-1) {
+        perror("shmat failed");
+        exit(1);
+    }
+    if (got == PAGES_FALLBACK_THP && madvise(shmaddr, size, MADV_HUGEPAGE) == -1)
+        perror("madvise(MADV_HUGEPAGE) ignored"); // Only a hint; carry on without it.
+    return shmaddr;
+}
+
+// Function to open a data-TLB read miss counter for this process (-1 if unavailable)
+int open_dtlb_counter(void) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HW_CACHE;
+    attr.config = PERF_COUNT_HW_CACHE_DTLB |
+                  (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                  (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Function to run one benchmark: the child fills the segment, the parent reads it randomly
+void run(size_t size, enum page_mode mode) {
+    enum page_mode got;
+    int shmid = create_segment(&size, mode, &got);
+
+    fflush(stdout); // Don't let the child inherit (and re-print) buffered output
+    pid_t pid = fork();
+    if (pid == -1) {
+        perror("fork failed");
+        exit(1);
+    }
+
+    if (pid == 0) { // Child: Writer
+        char *shmaddr = attach_segment(shmid, size, got);
+        memset(shmaddr, 1, size); // Touch every page
+        if (shmdt(shmaddr) == -1) {
+            perror("shmdt failed");
+            exit(1);
+        }
+        exit(0);
+    }
+
+    // Parent: Reader
+    if (waitpid(pid, NULL, 0) == -1) { // Wait for writer
+        perror("waitpid failed");
+        exit(1);
+    }
+    unsigned char *shmaddr = attach_segment(shmid, size, got);
+    memset(shmaddr, 1, size); // Fault the pages into our own page tables before timing
+
+    int fd = open_dtlb_counter();
+    if (fd != -1) {
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+    uint64_t x = 88172645463325252ULL, sum = 0;
+    size_t lines = size / 64;
+    double start = now_sec();
+    for (size_t i = 0; i < ACCESSES; i++) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17; // xorshift64
+        sum += shmaddr[(x % lines) * 64];
+    }
+    double elapsed = now_sec() - start;
+    uint64_t misses = 0;
+    if (fd != -1) {
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(fd, &misses, sizeof(misses)) != sizeof(misses))
+            misses = 0;
+        close(fd);
+    }
+
+    printf("%-17s %6zu MiB  %7.2f ns/read  ", mode_name(got), size / MIB,
+           elapsed * 1e9 / ACCESSES);
+    if (fd != -1)
+        printf("%10llu dTLB misses", (unsigned long long)misses);
+    else
+        printf("dTLB misses n/a (perf_event_open unavailable)");
+    printf("  (checksum %llu)\n", (unsigned long long)sum);
+
+    if (shmdt(shmaddr) == -1) {
+        perror("shmdt failed");
+        exit(1);
+    }
+    if (shmctl(shmid, IPC_RMID, NULL) == -1) {
+        perror("Cleaning up (shmctl) failed");
+        exit(1);
+    }
+}
+
+// Usage: shared_memory_hugepages [size_mib] [2m|1g]
+int main(int argc, char *argv[]) {
+    size_t size = (argc > 1 ? strtoul(argv[1], NULL, 10) : 256) * MIB;
+    enum page_mode huge = (argc > 2 && strcmp(argv[2], "1g") == 0) ? PAGES_HUGE_1GB : PAGES_HUGE_2MB;
+    if (size == 0) {
+        fprintf(stderr, "size must be at least 1 MiB\n");
+        exit(1);
+    }
+
+    run(size, PAGES_NORMAL);
+    run(size, huge);
+    return 0;
+}
@@ -0,0 +1,211 @@
+#define _GNU_SOURCE            // For mremap
+#include <sys/types.h>         // For pid_t
+#include <sys/ipc.h>           // For IPC_PRIVATE, etc.
+#include <sys/shm.h>           // For shared memory functions
+#include <sys/mman.h>          // For mmap, mremap, munmap
+#include <sys/wait.h>          // For wait
+#include <fcntl.h>             // For open
+#include <stdatomic.h>         // For atomic_* operations
+#include <stdint.h>            // For uint32_t, uint64_t
+#include <stdio.h>             // For printf, perror, snprintf
+#include <string.h>            // For memcpy, memset
+#include <stdlib.h>            // For exit
+#include <time.h>              // For clock_gettime
+#include <unistd.h>            // For fork, ftruncate, close
+#include <sched.h>             // For sched_yield
+
+// The "Shared Memory Data Logger" project: many writers, one drain, no locks.
+//
+// Writers reserve space in a ring with a single atomic fetch_add, fill in their record and
+// then mark it committed. They make no system calls (unless the ring is completely full).
+// A record whose reservation runs past the end of the ring becomes padding and the writer
+// simply reserves again. The drain process walks committed records in order, copies them
+// in large chunks into a memory-mapped output file, zeroes the space and then moves
+// the tail forward so writers can reuse the space.
+
+#define RING_SIZE (1 << 20)  // Must be a power of two
+#define CHUNK (256 * 1024)   // Bytes the drain handles per pass
+#define ALIGN 16             // Keeps every record header inside the ring
+
+enum { EMPTY = 0, COMMITTED = 1, PADDING = 2 };
+
+struct record_header {
+    _Atomic uint32_t state;
+    uint32_t total;          // Header + payload, rounded up to ALIGN
+    uint32_t length;         // Payload bytes
+    uint32_t unused;
+};
+
+struct log_ring {
+    _Alignas(64) _Atomic uint64_t reserved; // Writers: next byte to hand out
+    _Alignas(64) _Atomic uint64_t drained;  // Drain: everything before this is free again
+    _Atomic int writers_left;
+    _Alignas(64) char data[RING_SIZE];
+};
+
+// Function to append one record; lock-free and system-call free unless the ring is full
+void log_write(struct log_ring *r, const char *msg, uint32_t length) {
+    uint32_t total = (sizeof(struct record_header) + length + ALIGN - 1) & ~(uint32_t)(ALIGN - 1);
+    for (;;) {
+        uint64_t pos = atomic_fetch_add_explicit(&r->reserved, total, memory_order_relaxed);
+        // Wait until the drain has freed the space we were handed (only if the ring is full)
+        for (int spins = 0; pos + total - atomic_load_explicit(&r->drained, memory_order_acquire) > RING_SIZE; spins++) {
+            if (spins > 1000)
+                sched_yield();
+        }
+        uint64_t offset = pos & (RING_SIZE - 1);
+        struct record_header *h = (struct record_header *)(r->data + offset);
+        h->total = total;
+        if (offset + total > RING_SIZE) { // Would wrap: give the space back as padding
+            atomic_store_explicit(&h->state, PADDING, memory_order_release);
+            continue;
+        }
+        h->length = length;
+        memcpy(h + 1, msg, length);
+        atomic_store_explicit(&h->state, COMMITTED, memory_order_release);
+        return;
+    }
+}
+
+// Output file mapped into memory; grown by doubling
+struct output {
+    int fd;
+    char *map;
+    size_t used, capacity;
+};
+
+void output_reserve(struct output *out, size_t need) {
+    if (out->used + need <= out->capacity)
+        return;
+    size_t capacity = out->capacity * 2;
+    while (out->used + need > capacity)
+        capacity *= 2;
+    if (ftruncate(out->fd, capacity) == -1) {
+        perror("ftruncate failed");
+        exit(1);
+    }
+    out->map = mremap(out->map, out->capacity, capacity, MREMAP_MAYMOVE);
+    if (out->map == MAP_FAILED) {
+        perror("mremap failed");
+        exit(1);
+    }
+    out->capacity = capacity;
+}
+
+// Function to move one chunk of committed records to the file; returns bytes consumed
+uint64_t drain_once(struct log_ring *r, struct output *out) {
+    uint64_t start = atomic_load_explicit(&r->drained, memory_order_relaxed), tail = start;
+    while (tail - start < CHUNK) {
+        struct record_header *h = (struct record_header *)(r->data + (tail & (RING_SIZE - 1)));
+        uint32_t state = atomic_load_explicit(&h->state, memory_order_acquire);
+        if (state == EMPTY)
+            break; // Not committed yet: records must leave in order
+        if (state == COMMITTED) {
+            output_reserve(out, h->length);
+            memcpy(out->map + out->used, h + 1, h->length);
+            out->used += h->length;
+        }
+        tail += h->total;
+    }
+    // Zero the consumed bytes before publishing the space. Next lap's headers land at new
+    // offsets, possibly in the middle of old payloads, and must start out EMPTY.
+    uint64_t from = start & (RING_SIZE - 1), bytes = tail - start;
+    if (from + bytes > RING_SIZE) {
+        memset(r->data + from, 0, RING_SIZE - from);
+        memset(r->data, 0, from + bytes - RING_SIZE);
+    } else {
+        memset(r->data + from, 0, bytes);
+    }
+    atomic_store_explicit(&r->drained, tail, memory_order_release);
+    return tail - start;
+}
+
+double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main() {
+    int shmid = shmget(IPC_PRIVATE, sizeof(struct log_ring), IPC_CREAT | 0666);
+    if (shmid == -1) {
+        perror("shmget failed");
+        exit(1);
+    }
+    struct log_ring *r = shmat(shmid, NULL, 0); // Attached before fork: children inherit it
+    if (r == (void *)-1) {
+        perror("shmat failed");
+        exit(1);
+    }
+    int writers = 4, per_writer = 250000;
+    atomic_store(&r->writers_left, writers);
+
+    double start = now_sec();
+    for (int w = 0; w < writers; w++) {
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid == -1) {
+            perror("fork failed");
+            exit(1);
+        }
+        if (pid == 0) { // Child: Writer
+            char line[128];
+            for (int i = 0; i < per_writer; i++) {
+                int n = snprintf(line, sizeof(line), "writer %d sample %d value %d\n", w, i, (i * 31 + w) % 1000);
+                log_write(r, line, n);
+            }
+            atomic_fetch_sub(&r->writers_left, 1);
+            exit(0);
+        }
+    }
+
+    // Parent: Drain
+    struct output out = {-1, NULL, 0, 4 << 20};
+    out.fd = open("shared_memory_log.txt", O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (out.fd == -1 || ftruncate(out.fd, out.capacity) == -1) {
+        perror("open output failed");
+        exit(1);
+    }
+    out.map = mmap(NULL, out.capacity, PROT_READ | PROT_WRITE, MAP_SHARED, out.fd, 0);
+    if (out.map == MAP_FAILED) {
+        perror("mmap failed");
+        exit(1);
+    }
+    for (;;) {
+        int finished = atomic_load(&r->writers_left) == 0; // Check before draining, not after
+        if (drain_once(r, &out) == 0) {
+            if (finished && atomic_load(&r->drained) == atomic_load(&r->reserved))
+                break;
+            sched_yield(); // Nothing committed yet; the drain is allowed to make system calls
+        }
+    }
+    double elapsed = now_sec() - start;
+    for (int w = 0; w < writers; w++) {
+        if (wait(NULL) == -1) {
+            perror("wait failed");
+            exit(1);
+        }
+    }
+
+    long lines = 0;
+    for (size_t i = 0; i < out.used; i++)
+        lines += out.map[i] == '\n';
+    printf("Drained %ld records (%zu bytes) to shared_memory_log.txt in %.3f s: %.1f M records/s\n",
+           lines, out.used, elapsed, lines / elapsed / 1e6);
+    munmap(out.map, out.capacity);
+    if (ftruncate(out.fd, out.used) == -1) { // Trim the unused tail of the last growth step
+        perror("ftruncate failed");
+        exit(1);
+    }
+    close(out.fd);
+
+    if (shmdt(r) == -1) {
+        perror("shmdt failed");
+        exit(1);
+    }
+    if (shmctl(shmid, IPC_RMID, NULL) == -1) {
+        perror("Cleaning up (shmctl) failed");
+        exit(1);
+    }
+    return lines != (long)writers * per_writer;
+}
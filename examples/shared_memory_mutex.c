@@ -0,0 +1,297 @@
+#include <sys/types.h> // For pid_t
+#include <sys/ipc.h>   // For IPC_PRIVATE, etc.
+#include <sys/shm.h>   // For shared memory functions
+#include <sys/sem.h>   // For semaphore functions
+#include <sys/wait.h>  // For waitpid
+#include <errno.h>     // For EOWNERDEAD, ENOTRECOVERABLE
+#include <pthread.h>   // For process-shared mutexes and condition variables
+#include <signal.h>    // For raise, SIGKILL
+#include <stdio.h>     // For printf, perror, snprintf
+#include <string.h>    // For strerror
+#include <stdlib.h>    // For exit
+#include <time.h>      // For clock_gettime
+#include <unistd.h>    // For fork
+
+// A robust, process-shared mutex and condition variable stored in the segment.
+//
+// shared_memory.c synchronizes with sleep(), and semaphores.c with kernel semaphores, where
+// every down() and up() is a system call. A pthread mutex initialized with
+// PTHREAD_PROCESS_SHARED works across processes when it lives in shared memory, and only
+// enters the kernel (futex) when it is contended.
+//
+// PTHREAD_MUTEX_ROBUST covers crashes, the job SEM_UNDO does for semaphores: if the holder
+// dies, the next process to lock gets EOWNERDEAD instead of hanging. It owns the mutex,
+// but the protected data may be half-updated, so shm_lock() calls a repair function and
+// then marks the mutex consistent. A holder that dies without anyone repairing makes the
+// mutex unusable (ENOTRECOVERABLE) rather than letting corrupt data through.
+
+struct shm_sync {
+    pthread_mutex_t mutex;
+    pthread_cond_t changed;
+};
+
+// Function to initialize the mutex and condition variable (creator only, before sharing)
+void shm_sync_init(struct shm_sync *s) {
+    pthread_mutexattr_t ma;
+    pthread_condattr_t ca;
+    pthread_mutexattr_init(&ma);
+    pthread_mutexattr_setpshared(&ma, PTHREAD_PROCESS_SHARED);
+    pthread_mutexattr_setrobust(&ma, PTHREAD_MUTEX_ROBUST);
+    pthread_condattr_init(&ca);
+    pthread_condattr_setpshared(&ca, PTHREAD_PROCESS_SHARED);
+    int rc = pthread_mutex_init(&s->mutex, &ma);
+    if (rc == 0)
+        rc = pthread_cond_init(&s->changed, &ca);
+    if (rc != 0) {
+        fprintf(stderr, "pthread init failed: %s\n", strerror(rc));
+        exit(1);
+    }
+    pthread_mutexattr_destroy(&ma);
+    pthread_condattr_destroy(&ca);
+}
+
+// Handles the result of a lock or wait; repairs the data if the previous owner died
+int recover(struct shm_sync *s, int rc, void (*repair)(void *), void *data) {
+    if (rc == EOWNERDEAD) {
+        repair(data);
+        pthread_mutex_consistent(&s->mutex);
+        return 1;
+    }
+    if (rc != 0) {
+        fprintf(stderr, "pthread mutex failed: %s\n", strerror(rc));
+        exit(1);
+    }
+    return 0;
+}
+
+// Function to lock; returns 1 if a dead owner's data had to be repaired
+int shm_lock(struct shm_sync *s, void (*repair)(void *), void *data) {
+    return recover(s, pthread_mutex_lock(&s->mutex), repair, data);
+}
+
+void shm_unlock(struct shm_sync *s) {
+    pthread_mutex_unlock(&s->mutex);
+}
+
+// Function to wait for a change (the mutex must be held); returns like shm_lock
+int shm_wait(struct shm_sync *s, void (*repair)(void *), void *data) {
+    return recover(s, pthread_cond_wait(&s->changed, &s->mutex), repair, data);
+}
+
+void shm_broadcast(struct shm_sync *s) {
+    pthread_cond_broadcast(&s->changed);
+}
+
+// The protected data: a message board, consistent when count == number of filled entries
+#define ENTRIES 8
+
+struct board {
+    struct shm_sync sync;
+    int count;
+    char messages[ENTRIES][64];
+    long counter; // For the benchmark
+};
+
+// Function to restore the board's invariant after a crash
+void repair_board(void *data) {
+    struct board *b = data;
+    int n = 0;
+    while (n < ENTRIES && b->messages[n][0])
+        n++;
+    printf("Repair: count was %d, %d entries are filled\n", b->count, n);
+    b->count = n;
+}
+
+union semun { int val; }; // Union for semctl arguments
+
+// Function to perform a semaphore "down" (decrement) operation
+void down(int semid, int sem, int flags) {
+    struct sembuf op = {sem, -1, flags};
+    if (semop(semid, &op, 1) == -1) {
+        perror("down failed");
+        exit(1);
+    }
+}
+
+// Function to perform a semaphore "up" (increment) operation
+void up(int semid, int sem, int flags) {
+    struct sembuf op = {sem, 1, flags};
+    if (semop(semid, &op, 1) == -1) {
+        perror("up failed");
+        exit(1);
+    }
+}
+
+double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Function to time `n` lock/increment/unlock rounds in each of `procs` processes; ns per round
+double increments(struct board *b, int semid, int kind, int procs, long n) {
+    b->counter = 0;
+    double start = now_sec();
+    for (int p = 0; p < procs; p++) {
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid == -1) {
+            perror("fork failed");
+            exit(1);
+        }
+        if (pid == 0) {
+            for (long i = 0; i < n; i++) {
+                if (kind == 0) {
+                    shm_lock(&b->sync, repair_board, b);
+                    b->counter++;
+                    shm_unlock(&b->sync);
+                } else {
+                    down(semid, 0, kind == 2 ? SEM_UNDO : 0);
+                    b->counter++;
+                    up(semid, 0, kind == 2 ? SEM_UNDO : 0);
+                }
+            }
+            exit(0);
+        }
+    }
+    for (int p = 0; p < procs; p++) {
+        if (wait(NULL) == -1) {
+            perror("wait failed");
+            exit(1);
+        }
+    }
+    if (b->counter != procs * n) {
+        fprintf(stderr, "lost updates: %ld of %ld\n", b->counter, procs * n);
+        exit(1);
+    }
+    return (now_sec() - start) * 1e9 / (procs * n);
+}
+
+// Function to time a round trip between two processes (condition variable or two semaphores)
+double ping_pong(struct board *b, int semid, int use_mutex, long n) {
+    b->counter = 0;
+    double start = now_sec();
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == -1) {
+        perror("fork failed");
+        exit(1);
+    }
+    for (long i = 0; i < n; i++) {
+        int mine = pid == 0; // Parent moves on even counts, child on odd
+        if (use_mutex) {
+            shm_lock(&b->sync, repair_board, b);
+            while ((b->counter & 1) != mine)
+                shm_wait(&b->sync, repair_board, b);
+            b->counter++;
+            shm_broadcast(&b->sync);
+            shm_unlock(&b->sync);
+        } else {
+            down(semid, mine, 0);
+            b->counter++;
+            up(semid, !mine, 0);
+        }
+    }
+    if (pid == 0)
+        exit(0);
+    if (waitpid(pid, NULL, 0) == -1) {
+        perror("waitpid failed");
+        exit(1);
+    }
+    return (now_sec() - start) * 1e9 / n;
+}
+
+int main() {
+    int shmid = shmget(IPC_PRIVATE, sizeof(struct board), IPC_CREAT | 0666);
+    if (shmid == -1) {
+        perror("shmget failed");
+        exit(1);
+    }
+    struct board *b = shmat(shmid, NULL, 0); // Attached before fork: children inherit it
+    if (b == (void *)-1) {
+        perror("shmat failed");
+        exit(1);
+    }
+    shm_sync_init(&b->sync);
+    int semid = semget(IPC_PRIVATE, 2, IPC_CREAT | 0666); // For the benchmark
+    if (semid == -1) {
+        perror("semget failed");
+        exit(1);
+    }
+
+    // A child posts two messages, then dies half way through the third, holding the mutex
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == -1) {
+        perror("fork failed");
+        exit(1);
+    }
+    if (pid == 0) {
+        for (int i = 0; i < 3; i++) {
+            shm_lock(&b->sync, repair_board, b);
+            if (i == 2) {
+                b->count++; // Counted, but the text is never written
+                raise(SIGKILL);
+            }
+            snprintf(b->messages[b->count], sizeof(b->messages[0]), "Hello from child, message %d!", i);
+            b->count++;
+            shm_broadcast(&b->sync);
+            shm_unlock(&b->sync);
+        }
+        exit(0);
+    }
+
+    // Parent: wait for messages; notices the crash on the next lock or wakeup
+    int recovered = shm_lock(&b->sync, repair_board, b);
+    while (b->count < 2 && !recovered)
+        recovered = shm_wait(&b->sync, repair_board, b);
+    shm_unlock(&b->sync);
+    if (waitpid(pid, NULL, 0) == -1) {
+        perror("waitpid failed");
+        exit(1);
+    }
+    recovered |= shm_lock(&b->sync, repair_board, b);
+    for (int i = 0; i < b->count; i++)
+        printf("Parent read: %s\n", b->messages[i]);
+    printf("Holder crash detected (EOWNERDEAD): %s\n", recovered ? "yes" : "no");
+    shm_unlock(&b->sync);
+
+    // Benchmark against SysV semaphores
+    union semun arg = {1};
+    if (semctl(semid, 0, SETVAL, arg) == -1) {
+        perror("semctl failed");
+        exit(1);
+    }
+    long n = 200000;
+    printf("%-24s %12s %12s %14s\n", "ns per lock+unlock", "mutex", "semop", "semop+UNDO");
+    for (int procs = 1; procs <= 4; procs *= 2) {
+        double t[3];
+        for (int kind = 0; kind < 3; kind++)
+            t[kind] = increments(b, semid, kind, procs, n);
+        printf("%-2d process%-14s %12.1f %12.1f %14.1f\n", procs, procs > 1 ? "es" : "", t[0], t[1], t[2]);
+    }
+    arg.val = 0;
+    if (semctl(semid, 0, SETVAL, arg) == -1 || semctl(semid, 1, SETVAL, arg) == -1) {
+        perror("semctl failed");
+        exit(1);
+    }
+    up(semid, 0, 0); // The parent goes first
+    double mutex_rt = ping_pong(b, semid, 1, n / 4), sem_rt = ping_pong(b, semid, 0, n / 4);
+    printf("%-24s %12.1f %12.1f\n", "ns per handoff", mutex_rt, sem_rt);
+
+    pthread_mutex_destroy(&b->sync.mutex);
+    pthread_cond_destroy(&b->sync.changed);
+    if (shmdt(b) == -1) {
+        perror("shmdt failed");
+        exit(1);
+    }
+    if (shmctl(shmid, IPC_RMID, NULL) == -1) {
+        perror("Cleaning up (shmctl) failed");
+        exit(1);
+    }
+    if (semctl(semid, 0, IPC_RMID) == -1) {
+        perror("Cleaning up (semctl) failed");
+        exit(1);
+    }
+    return !recovered;
+}
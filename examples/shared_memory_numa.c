@@ -0,0 +1,207 @@
+#define _GNU_SOURCE            // For sched_setaffinity, CPU_SET
+#include <sys/types.h>         // For pid_t
+#include <sys/ipc.h>           // For IPC_PRIVATE, etc.
+#include <sys/shm.h>           // For shared memory functions
+#include <sys/syscall.h>       // For SYS_mbind
+#include <sys/wait.h>          // For waitpid
+#include <linux/mempolicy.h>   // For MPOL_BIND, MPOL_INTERLEAVE, MPOL_PREFERRED
+#include <sched.h>             // For sched_setaffinity, sched_yield
+#include <stdatomic.h>         // For atomic_* operations
+#include <stdint.h>            // For uint64_t
+#include <stdio.h>             // For printf, perror, fopen, fscanf
+#include <string.h>            // For strcmp
+#include <stdlib.h>            // For exit, atoi
+#include <time.h>              // For clock_gettime
+#include <unistd.h>            // For fork
+
+// NUMA placement for shared memory.
+//
+// On a multi-socket machine each socket ("node") has its own memory; reaching another
+// node's memory costs extra latency and shares a limited link. shmget() alone puts each
+// page on whichever node first touches it. shm_set_policy() fixes the placement instead
+// (bind to a node, prefer a node, or interleave across all nodes) with mbind(); because
+// SysV segments are shared objects, the policy applies to every process that attaches.
+// pin_to_node() keeps a process on the CPUs of one node, so producer, consumer and memory
+// can all be placed together. The benchmark compares local and remote placement.
+//
+// Raw system calls are used so the example builds without libnuma.
+
+#define SIZE (64UL << 20)
+#define LINE 64
+#define MAX_NODES 64
+
+struct line { _Alignas(LINE) _Atomic uint64_t value; };
+
+// Function to read the node count from sysfs (1 on machines without NUMA)
+int num_nodes(void) {
+    int first, last = 0;
+    FILE *f = fopen("/sys/devices/system/node/online", "r");
+    if (!f)
+        return 1;
+    if (fscanf(f, "%d-%d", &first, &last) < 2) // "0" on single-node machines, "0-1" on two
+        last = 0;
+    fclose(f);
+    return last + 1;
+}
+
+// Function to apply a NUMA policy to an attached segment before its pages are touched.
+// mode is MPOL_BIND, MPOL_PREFERRED or MPOL_INTERLEAVE; node is ignored for interleave.
+void shm_set_policy(void *addr, size_t size, int mode, int node) {
+    unsigned long mask = 0;
+    if (mode == MPOL_INTERLEAVE)
+        mask = (num_nodes() >= 64) ? ~0UL : (1UL << num_nodes()) - 1;
+    else
+        mask = 1UL << node;
+    if (syscall(SYS_mbind, addr, size, mode, &mask, MAX_NODES, 0) == -1) {
+        perror("mbind failed");
+        exit(1);
+    }
+}
+
+// Function to pin the calling process to the CPUs of one node
+void pin_to_node(int node) {
+    char path[64];
+    snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        perror("fopen cpulist failed");
+        exit(1);
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    int lo, hi;
+    char sep;
+    while (fscanf(f, "%d", &lo) == 1) { // Format: "0-3,8-11"
+        hi = lo;
+        if (fscanf(f, "%c", &sep) == 1 && sep == '-') {
+            if (fscanf(f, "%d", &hi) != 1)
+                break;
+            if (fscanf(f, "%c", &sep) != 1)
+                sep = '\n';
+        }
+        for (int cpu = lo; cpu <= hi; cpu++)
+            CPU_SET(cpu, &set);
+        if (sep != ',')
+            break;
+    }
+    fclose(f);
+    if (sched_setaffinity(0, sizeof(set), &set) == -1) {
+        perror("sched_setaffinity failed");
+        exit(1);
+    }
+}
+
+double now_nsec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+void wait_for(_Atomic uint64_t *v, uint64_t expect) {
+    for (int spins = 0; atomic_load_explicit(v, memory_order_acquire) != expect; spins++)
+        if (spins > 1000)
+            sched_yield(); // Fewer CPUs than spinners: let the other side run
+}
+
+// Function to benchmark one placement: memory (per `mode`) and producer on mem_node, consumer on cpu_node
+void run(int mode, int mem_node, int cpu_node) {
+    int shmid = shmget(IPC_PRIVATE, SIZE + sizeof(struct line), IPC_CREAT | 0666);
+    if (shmid == -1) {
+        perror("shmget failed");
+        exit(1);
+    }
+    char *base = shmat(shmid, NULL, 0); // Attached before fork: children inherit it
+    if (base == (void *)-1) {
+        perror("shmat failed");
+        exit(1);
+    }
+    shm_set_policy(base, SIZE + sizeof(struct line), mode, mem_node);
+    uint64_t *chase = (uint64_t *)base;         // Pointer-chasing cycle, one hop per cache line
+    struct line *flag = (struct line *)(base + SIZE); // Ping-pong cache line
+    size_t lines = SIZE / LINE;
+
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == -1) {
+        perror("fork failed");
+        exit(1);
+    }
+    if (pid == 0) { // Child: Producer, next to the memory
+        pin_to_node(mem_node);
+        // Random cyclic permutation of the cache lines (Sattolo's algorithm)
+        uint64_t x = 88172645463325252ULL;
+        for (size_t i = 0; i < lines; i++)
+            chase[i * LINE / 8] = i;
+        for (size_t i = lines - 1; i > 0; i--) {
+            x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+            size_t j = x % i;
+            uint64_t t = chase[i * LINE / 8];
+            chase[i * LINE / 8] = chase[j * LINE / 8];
+            chase[j * LINE / 8] = t;
+        }
+        atomic_store_explicit(&flag->value, 1, memory_order_release); // Ready
+        for (uint64_t round = 0; round < 100000; round++) { // Ping-pong: answer every odd value
+            wait_for(&flag->value, 2 * round + 2);
+            atomic_store_explicit(&flag->value, 2 * round + 3, memory_order_release);
+        }
+        exit(0);
+    }
+
+    // Parent: Consumer
+    pin_to_node(cpu_node);
+    wait_for(&flag->value, 1);
+    for (size_t i = 0; i < SIZE / 8; i += 4096 / 8)
+        (void)*(volatile uint64_t *)&chase[i]; // Map every page here too, outside the timing
+
+    double t0 = now_nsec();
+    uint64_t sum = 0;
+    for (size_t i = 0; i < SIZE / 8; i += 8)
+        sum += chase[i];
+    double t1 = now_nsec();
+    uint64_t at = 0;
+    for (size_t i = 0; i < 1000000; i++)
+        at = chase[at * LINE / 8];
+    double t2 = now_nsec();
+    for (uint64_t round = 0; round < 100000; round++) {
+        atomic_store_explicit(&flag->value, 2 * round + 2, memory_order_release);
+        wait_for(&flag->value, 2 * round + 3);
+    }
+    double t3 = now_nsec();
+
+    printf("memory on node %d, consumer on node %d: %6.2f GB/s sequential, %6.1f ns/dependent load, %7.1f ns/ping-pong  (%llu)\n",
+           mem_node, cpu_node, SIZE / (t1 - t0), (t2 - t1) / 1e6, (t3 - t2) / 1e5,
+           (unsigned long long)(sum + at));
+    if (waitpid(pid, NULL, 0) == -1) {
+        perror("waitpid failed");
+        exit(1);
+    }
+    if (shmdt(base) == -1) {
+        perror("shmdt failed");
+        exit(1);
+    }
+    if (shmctl(shmid, IPC_RMID, NULL) == -1) {
+        perror("Cleaning up (shmctl) failed");
+        exit(1);
+    }
+}
+
+// Usage: shared_memory_numa [local_node remote_node [bind|preferred|interleave]]
+int main(int argc, char *argv[]) {
+    int nodes = num_nodes();
+    const char *policy = argc > 3 ? argv[3] : "bind";
+    int mode = strcmp(policy, "interleave") == 0 ? MPOL_INTERLEAVE
+             : strcmp(policy, "preferred") == 0 ? MPOL_PREFERRED : MPOL_BIND;
+    int local = argc > 2 ? atoi(argv[1]) : 0;
+    int remote = argc > 2 ? atoi(argv[2]) : nodes - 1;
+    if (local < 0 || remote < 0 || local >= nodes || remote >= nodes) {
+        fprintf(stderr, "nodes must be between 0 and %d\n", nodes - 1);
+        exit(1);
+    }
+    printf("%d NUMA node(s) online, policy %s\n", nodes, policy);
+    run(mode, local, local);
+    if (remote != local)
+        run(mode, local, remote);
+    else
+        printf("Only one node: no remote placement to compare against\n");
+    return 0;
+}
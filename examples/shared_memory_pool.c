@@ -0,0 +1,223 @@
+#include <sys/types.h> // For pid_t
+#include <sys/ipc.h>   // For IPC_PRIVATE, etc.
+#include <sys/shm.h>   // For shared memory functions
+#include <sys/wait.h>  // For wait
+#include <stdatomic.h> // For atomic_* operations
+#include <stdint.h>    // For uint32_t, uint64_t
+#include <stdio.h>     // For printf, perror
+#include <stdlib.h>    // For exit, atoi
+#include <time.h>      // For clock_gettime
+#include <unistd.h>    // For fork
+
+// A pool of equal-sized message buffers in shared memory.
+//
+// Free slots sit on a lock-free stack (a Treiber stack) in the segment. Its top is one
+// 64-bit word holding (generation << 32 | slot index + 1); every push and pop bumps the
+// generation, so a compare-and-swap prepared from a stale top always fails, even if the
+// same slot is back on top by then (the ABA problem).
+//
+// The stack doesn't hold single slots but whole magazines: chains of MAGAZINE free slots.
+// Each process keeps one magazine to allocate from and one to free into, so it touches the
+// shared stack only once per MAGAZINE operations, and then moves a whole chain with one CAS.
+
+#define SLOTS 65536
+#define MAGAZINE 32
+#define PAYLOAD 256
+#define NONE 0 // Slot indexes are stored +1 so that 0 can mean "none"
+
+struct slot {
+    uint32_t next;           // Next slot in the same magazine
+    uint32_t next_magazine;  // Next magazine on the stack (only meaningful in a chain's first slot)
+    _Atomic uint32_t owner;  // Debugging aid: who holds the slot (0 = free)
+    char payload[PAYLOAD];
+};
+
+struct pool {
+    _Alignas(64) _Atomic uint64_t top; // (generation << 32) | first slot of the top magazine
+    _Alignas(64) struct slot slots[SLOTS];
+};
+
+// Process-local magazines
+struct magazine {
+    uint32_t slots[MAGAZINE];
+    int count;
+};
+
+struct pool_cache {
+    struct pool *pool;
+    struct magazine loaded;  // Allocate from here
+    struct magazine spare;   // Free into here once `loaded` is full
+    long shared_ops;         // How often we touched the shared stack
+};
+
+struct slot *slot_at(struct pool *p, uint32_t ref) {
+    return &p->slots[ref - 1];
+}
+
+// Function to push a full magazine (as a chain) with a single CAS
+void push_magazine(struct pool_cache *c, struct magazine *m) {
+    struct pool *p = c->pool;
+    for (int i = 0; i < m->count - 1; i++)
+        slot_at(p, m->slots[i])->next = m->slots[i + 1];
+    slot_at(p, m->slots[m->count - 1])->next = NONE;
+    uint32_t head = m->slots[0];
+    uint64_t old = atomic_load_explicit(&p->top, memory_order_relaxed), new;
+    do {
+        slot_at(p, head)->next_magazine = (uint32_t)old;
+        new = ((old >> 32) + 1) << 32 | head;
+    } while (!atomic_compare_exchange_weak_explicit(&p->top, &old, new, memory_order_release, memory_order_relaxed));
+    m->count = 0;
+    c->shared_ops++;
+}
+
+// Function to pop a magazine into `m`; returns 0 if the pool is empty
+int pop_magazine(struct pool_cache *c, struct magazine *m) {
+    struct pool *p = c->pool;
+    uint64_t old = atomic_load_explicit(&p->top, memory_order_acquire), new;
+    do {
+        uint32_t head = (uint32_t)old;
+        if (head == NONE)
+            return 0;
+        // May read a link another process just changed; then the generation moved on and the CAS fails
+        new = ((old >> 32) + 1) << 32 | slot_at(p, head)->next_magazine;
+    } while (!atomic_compare_exchange_weak_explicit(&p->top, &old, new, memory_order_acquire, memory_order_acquire));
+    m->count = 0;
+    for (uint32_t ref = (uint32_t)old; ref != NONE; ref = slot_at(p, ref)->next)
+        m->slots[m->count++] = ref;
+    c->shared_ops++;
+    return 1;
+}
+
+// Function to carve the whole segment into magazines (creator only, before anyone attaches)
+void pool_init(struct pool *p) {
+    struct pool_cache c = {p, {{0}, 0}, {{0}, 0}, 0};
+    atomic_store(&p->top, 0);
+    for (uint32_t ref = 1; ref <= SLOTS; ref++) {
+        c.loaded.slots[c.loaded.count++] = ref;
+        if (c.loaded.count == MAGAZINE)
+            push_magazine(&c, &c.loaded);
+    }
+}
+
+// Function to allocate one slot; returns its index + 1, or NONE if the pool is exhausted
+uint32_t pool_alloc(struct pool_cache *c) {
+    if (c->loaded.count == 0) {
+        if (c->spare.count > 0) { // Swap in the spare before going to the shared stack
+            struct magazine t = c->loaded;
+            c->loaded = c->spare;
+            c->spare = t;
+        } else if (!pop_magazine(c, &c->loaded)) {
+            return NONE;
+        }
+    }
+    return c->loaded.slots[--c->loaded.count];
+}
+
+// Function to give a slot back
+void pool_free(struct pool_cache *c, uint32_t ref) {
+    if (c->loaded.count == MAGAZINE) {
+        if (c->spare.count == MAGAZINE)
+            push_magazine(c, &c->spare);
+        struct magazine t = c->loaded;
+        c->loaded = c->spare;
+        c->spare = t;
+    }
+    c->loaded.slots[c->loaded.count++] = ref;
+}
+
+// Function to return everything this process holds (before it exits)
+void pool_flush(struct pool_cache *c) {
+    if (c->loaded.count)
+        push_magazine(c, &c->loaded);
+    if (c->spare.count)
+        push_magazine(c, &c->spare);
+}
+
+double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Usage: shared_memory_pool [processes]
+int main(int argc, char *argv[]) {
+    int procs = argc > 1 ? atoi(argv[1]) : 4;
+    if (procs < 1) {
+        fprintf(stderr, "need at least one process\n");
+        exit(1);
+    }
+    int shmid = shmget(IPC_PRIVATE, sizeof(struct pool), IPC_CREAT | 0666);
+    if (shmid == -1) {
+        perror("shmget failed");
+        exit(1);
+    }
+    struct pool *p = shmat(shmid, NULL, 0); // Attached before fork: children inherit it
+    if (p == (void *)-1) {
+        perror("shmat failed");
+        exit(1);
+    }
+    pool_init(p);
+
+    long rounds = 100000, burst = 100; // Each round: allocate a burst of buffers, then free them
+    for (int w = 0; w < procs; w++) {
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid == -1) {
+            perror("fork failed");
+            exit(1);
+        }
+        if (pid == 0) { // Child: Worker
+            struct pool_cache c = {p, {{0}, 0}, {{0}, 0}, 0};
+            uint32_t held[128];
+            long doubles = 0;
+            double start = now_sec();
+            for (long r = 0; r < rounds; r++) {
+                for (int i = 0; i < burst; i++) {
+                    held[i] = pool_alloc(&c);
+                    if (held[i] == NONE) {
+                        fprintf(stderr, "pool exhausted\n");
+                        exit(1);
+                    }
+                    uint32_t free_owner = 0; // Claim the slot; fails if someone else holds it
+                    doubles += !atomic_compare_exchange_strong(&slot_at(p, held[i])->owner, &free_owner, w + 1);
+                    slot_at(p, held[i])->payload[0] = (char)r;
+                }
+                for (int i = 0; i < burst; i++) {
+                    atomic_store(&slot_at(p, held[i])->owner, 0);
+                    pool_free(&c, held[i]);
+                }
+            }
+            double elapsed = now_sec() - start;
+            printf("Worker %d: %.1f ns per alloc+free, shared stack touched once per %.0f operations, %ld double allocations\n",
+                   w, elapsed * 1e9 / (rounds * burst), (double)rounds * burst * 2 / c.shared_ops, doubles);
+            pool_flush(&c);
+            exit(doubles != 0);
+        }
+    }
+
+    // Parent: wait, then check that every slot came back
+    int failed = 0;
+    for (int w = 0; w < procs; w++) {
+        int status;
+        if (wait(&status) == -1) {
+            perror("wait failed");
+            exit(1);
+        }
+        failed |= !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+    }
+    struct pool_cache c = {p, {{0}, 0}, {{0}, 0}, 0};
+    long free_slots = 0;
+    while (pop_magazine(&c, &c.loaded))
+        free_slots += c.loaded.count;
+    printf("Free slots after all workers exited: %ld of %d\n", free_slots, SLOTS);
+
+    if (shmdt(p) == -1) {
+        perror("shmdt failed");
+        exit(1);
+    }
+    if (shmctl(shmid, IPC_RMID, NULL) == -1) {
+        perror("Cleaning up (shmctl) failed");
+        exit(1);
+    }
+    return failed || free_slots != SLOTS;
+}
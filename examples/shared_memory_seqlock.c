@@ -0,0 +1,130 @@
+#include <sys/types.h> // For pid_t
+#include <sys/ipc.h>   // For IPC_PRIVATE, etc.
+#include <sys/shm.h>   // For shared memory functions
+#include <sys/wait.h>  // For wait
+#include <stdatomic.h> // For atomic_* operations
+#include <stdint.h>    // For uint64_t
+#include <stdio.h>     // For printf, perror, snprintf
+#include <string.h>    // For memcpy
+#include <stdlib.h>    // For exit
+#include <unistd.h>    // For fork
+#include <sched.h>     // For sched_yield
+
+// One writer, many read-only readers: a seqlock.
+//
+// The writer makes the sequence number odd, updates the record, then makes it even again.
+// A reader copies the record between two reads of the sequence number and keeps the copy
+// only if both reads saw the same even value. Readers attach with SHM_RDONLY, so they
+// provably never write a shared cache line: adding readers never slows the writer down.
+
+struct quote {
+    uint64_t update;   // Which update this is
+    double bid;
+    double ask;
+    double mid;        // Always (bid + ask) / 2 in a consistent snapshot
+    char symbol[16];
+};
+
+struct seqlock_region {
+    _Atomic uint64_t sequence; // Odd while the writer is updating
+    _Atomic int done;          // Set by the writer after its last update
+    struct quote record;
+};
+
+// Function to publish a new record (only one writer may call this)
+void seqlock_write(struct seqlock_region *r, const struct quote *q) {
+    uint64_t s = atomic_load_explicit(&r->sequence, memory_order_relaxed);
+    atomic_store_explicit(&r->sequence, s + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release); // Odd sequence is visible before the data changes
+    memcpy(&r->record, q, sizeof(*q));
+    atomic_store_explicit(&r->sequence, s + 2, memory_order_release);
+}
+
+// Function to copy a consistent snapshot; returns how many times it had to retry
+int seqlock_read(const struct seqlock_region *r, struct quote *q) {
+    for (int retries = 0;; retries++) {
+        uint64_t s1 = atomic_load_explicit(&r->sequence, memory_order_acquire);
+        if (s1 & 1) {
+            if (retries > 100)
+                sched_yield(); // The writer may have been preempted mid-update
+            continue;
+        }
+        memcpy(q, &r->record, sizeof(*q));
+        atomic_thread_fence(memory_order_acquire); // Data is read before the second check
+        if (atomic_load_explicit(&r->sequence, memory_order_relaxed) == s1)
+            return retries;
+    }
+}
+
+int main() {
+    int shmid = shmget(IPC_PRIVATE, sizeof(struct seqlock_region), IPC_CREAT | 0666);
+    if (shmid == -1) {
+        perror("shmget failed");
+        exit(1);
+    }
+
+    int readers = 4;
+    for (int i = 0; i < readers; i++) {
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid == -1) {
+            perror("fork failed");
+            exit(1);
+        }
+        if (pid == 0) { // Child: Reader
+            const struct seqlock_region *r = shmat(shmid, NULL, SHM_RDONLY); // Attach for read only.
+            if (r == (void *)-1) {
+                perror("shmat failed");
+                exit(1);
+            }
+            long snapshots = 0, retries = 0, torn = 0;
+            struct quote q = {0};
+            while (!atomic_load_explicit(&r->done, memory_order_acquire)) {
+                retries += seqlock_read(r, &q);
+                snapshots++;
+                torn += q.mid != (q.bid + q.ask) / 2;
+            }
+            printf("Reader %d: %ld snapshots, %ld retries, %ld torn, last update %llu (%s)\n",
+                   i, snapshots, retries, torn, (unsigned long long)q.update, q.symbol);
+            if (shmdt(r) == -1) {
+                perror("shmdt failed");
+                exit(1);
+            }
+            exit(torn != 0);
+        }
+    }
+
+    // Parent: Writer
+    struct seqlock_region *r = shmat(shmid, NULL, 0); // Attach for read/write.
+    if (r == (void *)-1) {
+        perror("shmat failed");
+        exit(1);
+    }
+    for (uint64_t u = 1; u <= 2000000; u++) {
+        struct quote q = {u, 100.0 + u % 97, 100.5 + u % 89, 0, ""};
+        q.mid = (q.bid + q.ask) / 2;
+        snprintf(q.symbol, sizeof(q.symbol), "IPC%llu", (unsigned long long)(u % 1000));
+        seqlock_write(r, &q);
+    }
+    atomic_store_explicit(&r->done, 1, memory_order_release);
+    printf("Writer: published 2000000 updates\n");
+
+    int failed = 0;
+    for (int i = 0; i < readers; i++) {
+        int status;
+        if (wait(&status) == -1) {
+            perror("wait failed");
+            exit(1);
+        }
+        failed |= !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+    }
+    if (shmdt(r) == -1) {
+        perror("shmdt failed");
+        exit(1);
+    }
+    if (shmctl(shmid, IPC_RMID, NULL) == -1) {
+        perror("Cleaning up (shmctl) failed");
+        exit(1);
+    }
+    return failed;
+}
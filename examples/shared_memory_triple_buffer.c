@@ -0,0 +1,153 @@
+#include <sys/types.h> // For pid_t
+#include <sys/ipc.h>   // For IPC_PRIVATE, etc.
+#include <sys/shm.h>   // For shared memory functions
+#include <sys/wait.h>  // For wait
+#include <stdatomic.h> // For atomic_* operations
+#include <stdint.h>    // For uint64_t
+#include <stdio.h>     // For printf, perror
+#include <string.h>    // For memcpy
+#include <stdlib.h>    // For exit
+#include <unistd.h>    // For fork, usleep
+
+// Triple-buffered game state ("Game Development" from the guide).
+//
+// Three frame buffers are shared between the simulation and one consumer. At any moment
+// the simulation owns one (it writes the next frame there), the consumer owns one (it
+// reads the latest frame it picked up) and the third sits in the middle. Publishing a
+// frame and picking up the newest one are each a single atomic exchange with the middle
+// slot, so neither side ever waits for the other and a frame is never seen half-written.
+// A triple buffer has exactly one consumer, so each consumer process gets its own channel.
+
+#define ENTITIES 256
+#define FRESH 4 // Set in `middle` when it holds a frame the consumer hasn't seen
+
+struct entity {
+    uint64_t tick; // Every entity carries the frame's tick, so a torn frame is easy to spot
+    float x, y, vx, vy;
+};
+
+struct frame {
+    uint64_t tick;
+    struct entity entities[ENTITIES];
+};
+
+struct triple_buffer {
+    _Atomic unsigned middle; // Buffer index (0-2) | FRESH
+    struct frame buffers[3];
+};
+
+enum { RENDER, AI, CONSUMERS };
+
+struct game_state {
+    _Atomic int done;
+    struct triple_buffer channels[CONSUMERS];
+};
+
+// Function to publish the frame in buffers[*back]; *back becomes the next buffer to write
+void tb_publish(struct triple_buffer *tb, unsigned *back) {
+    unsigned old = atomic_exchange_explicit(&tb->middle, *back | FRESH, memory_order_acq_rel);
+    *back = old & 3;
+}
+
+// Function to pick up the newest frame, if any; *front is the buffer to read afterwards.
+// Returns 1 if a new frame was picked up, 0 if *front still holds the latest one.
+int tb_acquire(struct triple_buffer *tb, unsigned *front) {
+    if (!(atomic_load_explicit(&tb->middle, memory_order_relaxed) & FRESH))
+        return 0;
+    unsigned old = atomic_exchange_explicit(&tb->middle, *front, memory_order_acq_rel);
+    *front = old & 3;
+    return 1;
+}
+
+void consume(struct game_state *g, int who, const char *name, useconds_t period) {
+    struct triple_buffer *tb = &g->channels[who];
+    unsigned front = 2; // Initial ownership: simulation 0, middle 1, consumer 2
+    long frames = 0, skipped = 0, torn = 0, repeats = 0;
+    uint64_t last = 0;
+    while (!atomic_load(&g->done)) {
+        if (!tb_acquire(tb, &front)) {
+            repeats++; // Nothing newer: keep showing the current frame
+        } else {
+            const struct frame *f = &tb->buffers[front];
+            for (int i = 0; i < ENTITIES; i++)
+                torn += f->entities[i].tick != f->tick;
+            if (last && f->tick > last + 1)
+                skipped += f->tick - last - 1; // Simulation ran ahead; we only want the latest
+            last = f->tick;
+            frames++;
+        }
+        usleep(period);
+    }
+    printf("%s: %ld frames, %ld skipped, %ld repeats, %ld torn, last tick %llu\n",
+           name, frames, skipped, repeats, torn, (unsigned long long)last);
+    exit(torn != 0);
+}
+
+int main() {
+    int shmid = shmget(IPC_PRIVATE, sizeof(struct game_state), IPC_CREAT | 0666);
+    if (shmid == -1) {
+        perror("shmget failed");
+        exit(1);
+    }
+    struct game_state *g = shmat(shmid, NULL, 0); // Attached before fork: children inherit it
+    if (g == (void *)-1) {
+        perror("shmat failed");
+        exit(1);
+    }
+    for (int c = 0; c < CONSUMERS; c++)
+        atomic_store(&g->channels[c].middle, 1);
+
+    const char *names[CONSUMERS] = {"Render", "AI"};
+    useconds_t periods[CONSUMERS] = {4000, 10000}; // Render at ~250 Hz, AI at ~100 Hz
+    for (int c = 0; c < CONSUMERS; c++) {
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid == -1) {
+            perror("fork failed");
+            exit(1);
+        }
+        if (pid == 0) // Child: Consumer
+            consume(g, c, names[c], periods[c]);
+    }
+
+    // Parent: Simulation at ~1 kHz
+    struct frame next = {0};
+    unsigned back[CONSUMERS] = {0, 0};
+    for (uint64_t tick = 1; tick <= 2000; tick++) {
+        next.tick = tick;
+        for (int i = 0; i < ENTITIES; i++) {
+            struct entity *e = &next.entities[i];
+            e->tick = tick;
+            e->vx = (float)(i % 7) - 3;
+            e->vy = (float)(i % 5) - 2;
+            e->x += e->vx * 0.001f;
+            e->y += e->vy * 0.001f;
+        }
+        for (int c = 0; c < CONSUMERS; c++) {
+            memcpy(&g->channels[c].buffers[back[c]], &next, sizeof(next));
+            tb_publish(&g->channels[c], &back[c]);
+        }
+        usleep(500);
+    }
+    atomic_store(&g->done, 1);
+    printf("Simulation: published 2000 frames\n");
+
+    int failed = 0;
+    for (int c = 0; c < CONSUMERS; c++) {
+        int status;
+        if (wait(&status) == -1) {
+            perror("wait failed");
+            exit(1);
+        }
+        failed |= !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+    }
+    if (shmdt(g) == -1) {
+        perror("shmdt failed");
+        exit(1);
+    }
+    if (shmctl(shmid, IPC_RMID, NULL) == -1) {
+        perror("Cleaning up (shmctl) failed");
+        exit(1);
+    }
+    return failed;
+}